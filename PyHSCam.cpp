@@ -23,20 +23,42 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 // sprintf and family "may be unsafe"
 #define _CRT_SECURE_NO_WARNINGS
 
+#include <winsock2.h>
+#include <ws2tcpip.h>
 #include <windows.h>
 #include <stdio.h>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <math.h>
 
 #include <boost/python.hpp>
 #include <exception>
 #include <string>
 #include <sstream>
 #include <ctime>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <tuple>
+#include <chrono>
+#include <emmintrin.h>
 
 #include "PDCLIB.h"
 
+#pragma comment(lib, "ws2_32.lib")
+
+
+struct Resolution
+{
+    unsigned long width;
+    unsigned long height;
+};
+
 
 // Function prototypes
 void
@@ -45,18 +67,30 @@ void
 uint64_t
     PyHSCam_openDeviceByIp(const char * ipStr);
 
+boost::python::list
+    PyHSCam_openDevicesByIp(boost::python::list ipStrs);
+
+uint64_t
+    PyHSCam_reconnect(uint64_t interfaceId);
+
 void
     PyHSCam_assertDeviceStatus(uint64_t interfaceId, unsigned long status);
 
 unsigned long
     PyHSCam_getCurrentCapRate(uint64_t interfaceId);
 
+std::vector<unsigned long>
+    PyHSCam_readValidCapRates(uint64_t interfaceId);
+
 boost::python::list
     PyHSCam_getValidCapRates(uint64_t interfaceId);
 
 void
     PyHSCam_setCapRate(uint64_t interfaceId, unsigned long capRate);
 
+Resolution
+    PyHSCam_getResolution(uint64_t interfaceId);
+
 boost::python::tuple
     PyHSCam_getCurrentResolution(uint64_t interfaceId);
 
@@ -66,6 +100,24 @@ void
 PyObject *  // PyBytes
     PyHSCam_captureLiveImage(uint64_t interfaceId);
 
+void
+    PyHSCam_captureDarkFrame(uint64_t interfaceId, unsigned long nFrames);
+
+void
+    PyHSCam_captureFlatFrame(uint64_t interfaceId, unsigned long nFrames);
+
+void
+    PyHSCam_loadCorrectionFrames(uint64_t interfaceId, boost::python::object dark, boost::python::object flat);
+
+boost::python::tuple
+    PyHSCam_getCorrectionFrames(uint64_t interfaceId);
+
+void
+    PyHSCam_setCorrection(uint64_t interfaceId, bool enabled, unsigned long outputBitDepth);
+
+void
+    PyHSCam_moveCorrection(uint64_t oldInterfaceId, uint64_t newInterfaceId);
+
 PyObject * // PyBytes
     PyHSCam_getImageFromMemory(uint64_t interfaceId, unsigned long frameN);
 
@@ -75,6 +127,12 @@ boost::python::list
 bool
     PyHSCam_isDeviceMonochromatic(uint64_t interfaceId);
 
+void
+    PyHSCam_setTransferBitDepth(uint64_t interfaceId, unsigned long bitDepth);
+
+std::string
+    PyHSCam_getPixelFormatName(uint64_t interfaceId);
+
 void
     PyHSCam_beginRecording(uint64_t interfaceId);
 
@@ -84,6 +142,23 @@ void
 void
     PyHSCam_recordBlocking(uint64_t interfaceId, uint64_t duration);
 
+void
+    PyHSCam_armTrigger(uint64_t interfaceId, std::string mode, unsigned long framesBefore,
+                        unsigned long framesAfter);
+
+void
+    PyHSCam_triggerIn(uint64_t interfaceId);
+
+bool
+    PyHSCam_waitForTrigger(uint64_t interfaceId, uint64_t timeout);
+
+boost::python::tuple
+    PyHSCam_getTriggerWindow(uint64_t interfaceId, unsigned long framesBefore,
+                                unsigned long framesAfter);
+
+long
+    PyHSCam_getTriggerFrame(uint64_t interfaceId);
+
 unsigned long
     PyHSCam_getStatus(uint64_t interfaceId);
 
@@ -93,6 +168,45 @@ long
 uint64_t
     PyHSCam_getMaxRecordingTime(uint64_t interfaceId);
 
+unsigned long
+    PyHSCam_downloadToFile(uint64_t interfaceId, std::string path,
+                            unsigned long startFrame, unsigned long frameCount,
+                            bool overview);
+
+boost::python::dict
+    PyHSCam_reduceMemory(uint64_t interfaceId, boost::python::list ops,
+                            unsigned long startFrame, unsigned long frameCount);
+
+void
+    PyHSCam_createFrameRing(uint64_t interfaceId, std::string name, unsigned long slotCount);
+
+void
+    PyHSCam_destroyFrameRing(uint64_t interfaceId);
+
+void
+    PyHSCam_moveFrameRing(uint64_t oldInterfaceId, uint64_t newInterfaceId);
+
+long
+    PyHSCam_publishLiveImage(uint64_t interfaceId);
+
+long
+    PyHSCam_publishMemoryImages(uint64_t interfaceId, unsigned long startFrame, unsigned long frameCount);
+
+void
+    PyHSCam_startFrameServer(uint64_t interfaceId, unsigned short port, std::string bindAddress);
+
+void
+    PyHSCam_stopFrameServer(uint64_t interfaceId);
+
+bool
+    PyHSCam_isFrameServerRunning(uint64_t interfaceId);
+
+double
+    PyHSCam_timeRawGetStatus(uint64_t interfaceId, unsigned long iterations);
+
+void
+    PyHSCam_registerFastCalls();
+
 
 // Combine deviceNum and childNum into a single uint64_t
 #define IFACE_ID_FIELD_OFFSET 32
@@ -195,9 +309,300 @@ void convertCppExceptionToPy(CamRuntimeError const &except)
 }
 
 
+// The SDK isn't documented as thread safe, and it is called from frame server threads as
+// well as from python. Every function that calls into the SDK holds this lock while doing
+// so. It is recursive because those functions call each other.
+std::recursive_mutex sdkMutex;
+typedef std::lock_guard<std::recursive_mutex> SdkLock;
+// Frame server clients streaming live images, keyed by interfaceId. Guarded by sdkMutex.
+// The device can't leave LIVE status, and the frame size can't change, while any are
+// connected, since each subscriber sized its frame buffer when it subscribed.
+std::map<uint64_t, unsigned long> liveSubscribers;
+
+bool PyHSCam_hasLiveSubscribers(uint64_t interfaceId)
+{
+    // Call with sdkMutex held
+    std::map<uint64_t, unsigned long>::const_iterator it = liveSubscribers.find(interfaceId);
+    return it != liveSubscribers.end() && it->second > 0;
+}
+
+class GilRelease
+{
+    // Lets other python threads run during long device transfers and waits. Nothing may
+    // touch python objects while one of these is alive; SDK calls are still serialized by
+    // sdkMutex, which must never be held while taking the GIL back.
+private:
+    PyThreadState * threadState;
+public:
+    GilRelease() : threadState(PyEval_SaveThread())
+    {
+    }
+    ~GilRelease()
+    {
+        PyEval_RestoreThread(threadState);
+    }
+};
+
+
+// Pixel formats
+// Each format the module can transfer is described by a traits class so that per-pixel
+// kernels can be instantiated for it. A device's format is resolved once (from its colour
+// type and the requested transfer bit depth) and cached; hot paths dispatch on the cached
+// format id to the matching template instantiation.
+enum PixelFormatId
+{
+    PIXEL_FORMAT_MONO8,
+    PIXEL_FORMAT_MONO16,
+    PIXEL_FORMAT_BGR8,      // Interleaved BGRBGR...
+    PIXEL_FORMAT_BGR16
+};
+
+template <typename SampleType, unsigned long Channels, PixelFormatId Id>
+struct PixelFormatTraits
+{
+    typedef SampleType Sample;
+    static const PixelFormatId id = Id;
+    static const unsigned long channels = Channels;
+    static const unsigned long bitDepth = sizeof(SampleType) * 8;  // Passed to PDC_Get*ImageData
+    static const unsigned long bytesPerPixel = sizeof(SampleType) * Channels;
+};
+
+typedef PixelFormatTraits<uint8_t, 1, PIXEL_FORMAT_MONO8> Mono8Format;
+typedef PixelFormatTraits<uint16_t, 1, PIXEL_FORMAT_MONO16> Mono16Format;
+typedef PixelFormatTraits<uint8_t, 3, PIXEL_FORMAT_BGR8> Bgr8Format;
+typedef PixelFormatTraits<uint16_t, 3, PIXEL_FORMAT_BGR16> Bgr16Format;
+
+struct PixelFormat
+{
+    // Runtime copy of a traits class for code that only needs sizes
+    PixelFormatId id;
+    unsigned long channels;
+    unsigned long bitDepth;
+    unsigned long bytesPerPixel;
+
+    size_t frameSize(unsigned long width, unsigned long height) const
+    {
+        return (size_t)width * height * bytesPerPixel;
+    }
+    size_t sampleCount(unsigned long width, unsigned long height) const
+    {
+        return (size_t)width * height * channels;
+    }
+};
+
+template <class Format>
+PixelFormat PyHSCam_makePixelFormat(void)
+{
+    PixelFormat format;
+    format.id = Format::id;
+    format.channels = Format::channels;
+    format.bitDepth = Format::bitDepth;
+    format.bytesPerPixel = Format::bytesPerPixel;
+    return format;
+}
+
+template <class Kernel>
+typename Kernel::Result PyHSCam_dispatchPixelFormat(PixelFormatId id, Kernel & kernel)
+{
+    // Call kernel.run<Format>() for the traits class matching id.
+    switch (id)
+    {
+    case PIXEL_FORMAT_MONO8:
+        return kernel.template run<Mono8Format>();
+    case PIXEL_FORMAT_MONO16:
+        return kernel.template run<Mono16Format>();
+    case PIXEL_FORMAT_BGR8:
+        return kernel.template run<Bgr8Format>();
+    case PIXEL_FORMAT_BGR16:
+        return kernel.template run<Bgr16Format>();
+    }
+    throw CamRuntimeError("Unknown pixel format. This should never happen.");
+}
+
+const char * pixelFormatNames[] = { "mono8", "mono16", "bgr8", "bgr16" };
+
+// Resolved formats, keyed by interfaceId. Also read from frame server threads.
+std::map<uint64_t, PixelFormat> deviceFormats;
+std::mutex deviceFormatMutex;
+
+
+PixelFormat PyHSCam_getPixelFormat(uint64_t interfaceId)
+{
+    // Resolve the device's format on first use. Devices default to 8-bit transfers.
+    SdkLock sdkLock(sdkMutex);
+
+    std::lock_guard<std::mutex> lock(deviceFormatMutex);
+    std::map<uint64_t, PixelFormat>::const_iterator it = deviceFormats.find(interfaceId);
+    if (it != deviceFormats.end())
+    {
+        return it->second;
+    }
+
+    PixelFormat format;
+    if (PyHSCam_isDeviceMonochromatic(interfaceId))
+    {
+        format = PyHSCam_makePixelFormat<Mono8Format>();
+    }
+    else
+    {
+        format = PyHSCam_makePixelFormat<Bgr8Format>();
+    }
+    deviceFormats[interfaceId] = format;
+    return format;
+}
+
+std::string PyHSCam_getPixelFormatName(uint64_t interfaceId)
+{
+    return pixelFormatNames[PyHSCam_getPixelFormat(interfaceId).id];
+}
+
+void PyHSCam_setTransferBitDepth(uint64_t interfaceId, unsigned long bitDepth)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    if (PyHSCam_hasLiveSubscribers(interfaceId))
+    {
+        throw CamRuntimeError("Cannot change the transfer bit depth while a frame server client "
+                                "is subscribed to live images.");
+    }
+
+    bool mono = PyHSCam_isDeviceMonochromatic(interfaceId);
+    PixelFormat format;
+    if (bitDepth == 8)
+    {
+        format = mono ? PyHSCam_makePixelFormat<Mono8Format>() : PyHSCam_makePixelFormat<Bgr8Format>();
+    }
+    else if (bitDepth == 16)
+    {
+        format = mono ? PyHSCam_makePixelFormat<Mono16Format>() : PyHSCam_makePixelFormat<Bgr16Format>();
+    }
+    else
+    {
+        throw CamRuntimeError("Transfer bit depth must be 8 or 16.");
+    }
+    std::lock_guard<std::mutex> lock(deviceFormatMutex);
+    deviceFormats[interfaceId] = format;
+}
+
+
+// Detected devices are cached on disk so that subsequent runs (or a reconnect after a
+// dropped link) can skip PDC_DetectDevice and the PDC_IsFunction probe entirely.
+// One line per device:
+//   ip deviceCode tmpDeviceNo interfaceCode burstTransfer width height capRate
+// width, height and capRate are 0 until the corresponding setting has been made.
+#define DEVICE_CACHE_PATH "PyHSCam.devcache"
+
+struct DeviceCacheEntry
+{
+    unsigned long ipNumeric;
+    PDC_DETECT_INFO detectInfo;
+    bool burstTransferSupported;
+    unsigned long width;
+    unsigned long height;
+    unsigned long capRate;
+};
+
+// Keyed by numeric ip
+std::map<unsigned long, DeviceCacheEntry> deviceCache;
+// Maps an open interfaceId back to the ip it was opened with
+std::map<uint64_t, unsigned long> openDeviceIps;
+// Guards both of the above - devices may be opened from several threads at once
+std::mutex deviceCacheMutex;
+
+
+void PyHSCam_loadDeviceCache(void)
+{
+    FILE * cacheFile = fopen(DEVICE_CACHE_PATH, "r");
+    if (cacheFile == NULL)
+    {
+        // No cache yet - every device will be detected the slow way
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(deviceCacheMutex);
+
+    DeviceCacheEntry entry;
+    unsigned int burst;
+    while (fscanf(cacheFile,
+                    "%lx %lx %lx %lx %u %lu %lu %lu",
+                    &entry.ipNumeric,
+                    &entry.detectInfo.m_nDeviceCode,
+                    &entry.detectInfo.m_nTmpDeviceNo,
+                    &entry.detectInfo.m_nInterfaceCode,
+                    &burst,
+                    &entry.width,
+                    &entry.height,
+                    &entry.capRate) == 8)
+    {
+        entry.burstTransferSupported = (burst != 0);
+        deviceCache[entry.ipNumeric] = entry;
+    }
+
+    fclose(cacheFile);
+}
+
+void PyHSCam_saveDeviceCache(void)
+{
+    // The caller must hold deviceCacheMutex.
+    // Failing to write the cache is not fatal - the next run will just detect again.
+    FILE * cacheFile = fopen(DEVICE_CACHE_PATH, "w");
+    if (cacheFile == NULL)
+    {
+        return;
+    }
+
+    std::map<unsigned long, DeviceCacheEntry>::const_iterator it;
+    for (it = deviceCache.begin(); it != deviceCache.end(); ++it)
+    {
+        const DeviceCacheEntry & entry = it->second;
+        fprintf(cacheFile,
+                "%lx %lx %lx %lx %u %lu %lu %lu\n",
+                entry.ipNumeric,
+                entry.detectInfo.m_nDeviceCode,
+                entry.detectInfo.m_nTmpDeviceNo,
+                entry.detectInfo.m_nInterfaceCode,
+                entry.burstTransferSupported ? 1 : 0,
+                entry.width,
+                entry.height,
+                entry.capRate);
+    }
+
+    fclose(cacheFile);
+}
+
+void PyHSCam_rememberDeviceSettings(uint64_t interfaceId,
+                                    unsigned long width,
+                                    unsigned long height,
+                                    unsigned long capRate)
+{
+    // Record the last applied settings for interfaceId so reconnect() can restore them.
+    // A value of 0 leaves that setting unchanged.
+    std::lock_guard<std::mutex> lock(deviceCacheMutex);
+
+    std::map<uint64_t, unsigned long>::const_iterator ipIt = openDeviceIps.find(interfaceId);
+    if (ipIt == openDeviceIps.end())
+    {
+        return;
+    }
+    DeviceCacheEntry & entry = deviceCache[ipIt->second];
+    if (width != 0 && height != 0)
+    {
+        entry.width = width;
+        entry.height = height;
+    }
+    if (capRate != 0)
+    {
+        entry.capRate = capRate;
+    }
+    PyHSCam_saveDeviceCache();
+}
+
+
 void PyHSCam_init(void)
 {
     // Add a search directory for dlls
+    SdkLock sdkLock(sdkMutex);
+
     if (0 == SetDllDirectory("dll/"))
     {
         throw CamRuntimeError("SetDllDirectory failed!");
@@ -211,14 +616,13 @@ void PyHSCam_init(void)
     {
         throw CamRuntimeError("Init failed!", errorCode);
     }
+
+    PyHSCam_loadDeviceCache();
 }
 
 
-uint64_t PyHSCam_openDeviceByIp(const char * ipStr)
+unsigned long PyHSCam_parseIp(const char * ipStr)
 {
-    unsigned long retVal;
-    unsigned long errorCode;
-
     // Convert ip string to 32 bit int
     // Eg: "192.168.1.10" -> 0xc0a8000a
     unsigned long ipNumeric = 0;
@@ -228,6 +632,16 @@ uint64_t PyHSCam_openDeviceByIp(const char * ipStr)
     {
         ipNumeric = (ipNumeric << 8) | std::stoi(item);
     }
+    return ipNumeric;
+}
+
+
+PDC_DETECT_INFO PyHSCam_detectDevice(unsigned long ipNumeric)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
 
     PDC_DETECT_NUM_INFO detectedNumInfo;
     unsigned long ipList[PDC_MAX_DEVICE];
@@ -261,14 +675,24 @@ uint64_t PyHSCam_openDeviceByIp(const char * ipStr)
     //TODO: Should we specify the model to validate the camera?
     // eg. Fastcam 4 : (dectNumInfo.m_DetectInfo[0].m_nDeviceCode == PDC_DEVTYPE_FCAM_SA4)
 
-    // No errors - open the located device
-    // TODO: Expect only one device at a at a time. This init function will
-    // need to be rearranged if we want to expect >1 device open.
-    // Should also account for devices with >1 child devices
+    return detectedNumInfo.m_DetectInfo[0];
+}
+
+
+uint64_t PyHSCam_openDetectedDevice(DeviceCacheEntry & entry, bool probeFunctions)
+{
+    // Open a device that has already been detected. If probeFunctions is false
+    // the cached capabilities in entry are trusted instead of asking the device.
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+
+    // TODO: Should also account for devices with >1 child devices
     // (devices which have multiple camera heads).
     unsigned long deviceNum;
     unsigned long childNum;
-    retVal = PDC_OpenDevice(&(detectedNumInfo.m_DetectInfo[0]),
+    retVal = PDC_OpenDevice(&(entry.detectInfo),
                             &deviceNum,     // Output
                             &errorCode);    // Output
     if (retVal == PDC_FAILED)
@@ -280,77 +704,262 @@ uint64_t PyHSCam_openDeviceByIp(const char * ipStr)
 
     // TODO: Return a list of IDs (required for supporting more than one child).
 
-    // Enable burst transfer if possible
-    char functionStatus;
-    retVal = PDC_IsFunction(deviceNum,
-                                childNum,
-                                PDC_EXIST_BURST_TRANSFER,
-                                &functionStatus,    // Output
-                                &errorCode);        // Output
-
-    if (retVal == PDC_FAILED)
-    {
-        throw CamRuntimeError("Failed to retrieve status of library function!", errorCode);
-    }
-    if (functionStatus == PDC_EXIST_SUPPORTED)
+    try
     {
-        retVal = PDC_SetBurstTransfer(deviceNum,
-                                        PDC_FUNCTION_ON,
-                                        &errorCode);
-        if (retVal == PDC_FAILED)
+        if (probeFunctions)
         {
-            throw CamRuntimeError("Failed to enable burst transfer mode!", errorCode);
+            char functionStatus;
+            retVal = PDC_IsFunction(deviceNum,
+                                        childNum,
+                                        PDC_EXIST_BURST_TRANSFER,
+                                        &functionStatus,    // Output
+                                        &errorCode);        // Output
+
+            if (retVal == PDC_FAILED)
+            {
+                throw CamRuntimeError("Failed to retrieve status of library function!", errorCode);
+            }
+            entry.burstTransferSupported = (functionStatus == PDC_EXIST_SUPPORTED);
         }
+
+        // Enable burst transfer if possible
+        if (entry.burstTransferSupported)
+        {
+            retVal = PDC_SetBurstTransfer(deviceNum,
+                                            PDC_FUNCTION_ON,
+                                            &errorCode);
+            if (retVal == PDC_FAILED)
+            {
+                throw CamRuntimeError("Failed to enable burst transfer mode!", errorCode);
+            }
+        }
+    }
+    catch (CamRuntimeError &)
+    {
+        // Don't leak the handle - the caller may retry with a fresh detect
+        PDC_CloseDevice(deviceNum, &errorCode);
+        throw;
     }
 
     return IFACE_ID_FROM_VALUES(deviceNum, childNum);
 }
 
-void PyHSCam_assertDeviceStatus(uint64_t interfaceId, unsigned long status)
-{
-    // Ensure the device is in the necessary status and if it isn't, set it.
-    // Changing the device status is fairly costly so we want to change
-    // it as infrequently as possible.
-    unsigned long retVal;
-    unsigned long errorCode;
 
-    unsigned long deviceStatus;
-    deviceStatus = PyHSCam_getStatus(interfaceId);
+uint64_t PyHSCam_openDeviceByNumericIp(unsigned long ipNumeric)
+{
+    // Open using the cached descriptor when we have one; fall back to a full
+    // search if the device isn't cached or the cached descriptor is stale.
+    DeviceCacheEntry entry;
+    bool cached;
+    {
+        std::lock_guard<std::mutex> lock(deviceCacheMutex);
+        std::map<unsigned long, DeviceCacheEntry>::const_iterator it = deviceCache.find(ipNumeric);
+        cached = (it != deviceCache.end());
+        if (cached)
+        {
+            entry = it->second;
+        }
+    }
 
-    if (deviceStatus != status)
+    uint64_t interfaceId;
+    bool opened = false;
+    if (cached)
     {
-        retVal = PDC_SetStatus(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                status,
-                                &errorCode);
-        if (retVal == PDC_FAILED)
+        try
         {
-            throw CamRuntimeError("Failed to set status!", errorCode);
+            interfaceId = PyHSCam_openDetectedDevice(entry, false);
+            opened = true;
+        }
+        catch (CamRuntimeError &)
+        {
+            // Stale cache entry (device swapped, firmware changed, ...) - detect from scratch
+        }
+    }
+    if (!opened)
+    {
+        entry.ipNumeric = ipNumeric;
+        entry.detectInfo = PyHSCam_detectDevice(ipNumeric);
+        if (!cached)
+        {
+            entry.width = 0;
+            entry.height = 0;
+            entry.capRate = 0;
         }
+        interfaceId = PyHSCam_openDetectedDevice(entry, true);
     }
+
+    std::lock_guard<std::mutex> lock(deviceCacheMutex);
+    deviceCache[ipNumeric] = entry;
+    openDeviceIps[interfaceId] = ipNumeric;
+    PyHSCam_saveDeviceCache();
+
+    return interfaceId;
 }
 
-unsigned long PyHSCam_getCurrentCapRate(uint64_t interfaceId)
+
+uint64_t PyHSCam_openDeviceByIp(const char * ipStr)
 {
-    unsigned long retVal;
-    unsigned long errorCode;
-    unsigned long capRate;
+    return PyHSCam_openDeviceByNumericIp(PyHSCam_parseIp(ipStr));
+}
 
-    retVal = PDC_GetRecordRate(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                &capRate,
-                                &errorCode);
-    if (retVal == PDC_FAILED)
+
+boost::python::list PyHSCam_openDevicesByIp(boost::python::list ipStrs)
+{
+    // Open several devices. The opens run one after another because every SDK call is
+    // serialized by sdkMutex; cached devices skip the device search so each one is quick.
+    // All ips are parsed first so a typo fails before any device is opened.
+    long ipCnt = boost::python::len(ipStrs);
+    std::vector<unsigned long> ipList(ipCnt);
+
+    long i;
+    for (i = 0; i < ipCnt; i++)
     {
-        throw CamRuntimeError("Failed to retrieve current capture rate!", errorCode);
+        std::string ipStr = boost::python::extract<std::string>(ipStrs[i]);
+        ipList[i] = PyHSCam_parseIp(ipStr.c_str());
     }
-    return capRate;
+
+    boost::python::list pyInterfaceIds;
+    for (i = 0; i < ipCnt; i++)
+    {
+        pyInterfaceIds.append(PyHSCam_openDeviceByNumericIp(ipList[i]));
+    }
+
+    return pyInterfaceIds;
 }
 
-boost::python::list PyHSCam_getValidCapRates(uint64_t interfaceId)
+
+uint64_t PyHSCam_reconnect(uint64_t interfaceId)
 {
-    unsigned long retVal;
-    unsigned long errorCode;
-    unsigned long modeCnt;
+    // Close (if still possible) and reopen the device behind interfaceId using the
+    // cached descriptor, then restore the last resolution and capture rate.
+    // Returns the new interfaceId; the old one must not be used afterwards. If the
+    // device can't be reopened yet the old interfaceId stays valid for another attempt.
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long ipNumeric;
+    {
+        std::lock_guard<std::mutex> lock(deviceCacheMutex);
+        std::map<uint64_t, unsigned long>::iterator it = openDeviceIps.find(interfaceId);
+        if (it == openDeviceIps.end())
+        {
+            throw CamRuntimeError("Cannot reconnect - interfaceId was not opened by this module.");
+        }
+        ipNumeric = it->second;
+    }
+    // Server threads keep using the interfaceId they were started with, so they can't
+    // follow the device to a new one.
+    if (PyHSCam_isFrameServerRunning(interfaceId))
+    {
+        throw CamRuntimeError("Cannot reconnect while a frame server is running - stop it first.");
+    }
+
+    // The link may already be gone so a failure here is expected and ignored.
+    unsigned long errorCode;
+    PDC_CloseDevice(IFACE_ID_GET_DEV_NUM(interfaceId), &errorCode);
+
+    uint64_t newInterfaceId = PyHSCam_openDeviceByNumericIp(ipNumeric);
+    if (newInterfaceId != interfaceId)
+    {
+        std::lock_guard<std::mutex> lock(deviceCacheMutex);
+        openDeviceIps.erase(interfaceId);
+    }
+
+    // Keep the transfer format that was selected for the old interfaceId
+    {
+        std::lock_guard<std::mutex> lock(deviceFormatMutex);
+        std::map<uint64_t, PixelFormat>::iterator it = deviceFormats.find(interfaceId);
+        if (it != deviceFormats.end() && newInterfaceId != interfaceId)
+        {
+            deviceFormats[newInterfaceId] = it->second;
+            deviceFormats.erase(interfaceId);
+        }
+    }
+    PyHSCam_moveCorrection(interfaceId, newInterfaceId);
+    PyHSCam_moveFrameRing(interfaceId, newInterfaceId);
+    // Only frame server connections subscribe, and there is no server for interfaceId
+    liveSubscribers.erase(interfaceId);
+
+    DeviceCacheEntry entry;
+    {
+        std::lock_guard<std::mutex> lock(deviceCacheMutex);
+        entry = deviceCache[ipNumeric];
+    }
+    // The setters switch the device to LIVE, which would interrupt a playback offload,
+    // so only call them if the device actually lost its settings.
+    if (entry.width != 0 && entry.height != 0)
+    {
+        Resolution resolution = PyHSCam_getResolution(newInterfaceId);
+        if (resolution.width != entry.width || resolution.height != entry.height)
+        {
+            PyHSCam_setResolution(newInterfaceId, entry.width, entry.height);
+        }
+    }
+    if (entry.capRate != 0 && PyHSCam_getCurrentCapRate(newInterfaceId) != entry.capRate)
+    {
+        PyHSCam_setCapRate(newInterfaceId, entry.capRate);
+    }
+
+    return newInterfaceId;
+}
+
+
+void PyHSCam_assertDeviceStatus(uint64_t interfaceId, unsigned long status)
+{
+    // Ensure the device is in the necessary status and if it isn't, set it.
+    // Changing the device status is fairly costly so we want to change
+    // it as infrequently as possible.
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+
+    unsigned long deviceStatus;
+    deviceStatus = PyHSCam_getStatus(interfaceId);
+
+    if (deviceStatus != status)
+    {
+        if (deviceStatus == PDC_STATUS_LIVE && PyHSCam_hasLiveSubscribers(interfaceId))
+        {
+            throw CamRuntimeError("Cannot change the device status while a frame server client "
+                                    "is subscribed to live images.");
+        }
+        retVal = PDC_SetStatus(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                status,
+                                &errorCode);
+        if (retVal == PDC_FAILED)
+        {
+            throw CamRuntimeError("Failed to set status!", errorCode);
+        }
+    }
+}
+
+unsigned long PyHSCam_getCurrentCapRate(uint64_t interfaceId)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+    unsigned long capRate;
+
+    retVal = PDC_GetRecordRate(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                &capRate,
+                                &errorCode);
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to retrieve current capture rate!", errorCode);
+    }
+    return capRate;
+}
+
+std::vector<unsigned long> PyHSCam_readValidCapRates(uint64_t interfaceId)
+{
+    // Plain C++ version of getValidCapRates()
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+    unsigned long modeCnt;
     unsigned long modeList[PDC_MAX_LIST_NUMBER];
 
     retVal = PDC_GetRecordRateList(IFACE_ID_GET_DEV_NUM(interfaceId),
@@ -363,10 +972,17 @@ boost::python::list PyHSCam_getValidCapRates(uint64_t interfaceId)
         throw CamRuntimeError("Failed to retrieve rate list!", errorCode);
     }
 
+    return std::vector<unsigned long>(modeList, modeList + modeCnt);
+}
+
+boost::python::list PyHSCam_getValidCapRates(uint64_t interfaceId)
+{
+    std::vector<unsigned long> modeList = PyHSCam_readValidCapRates(interfaceId);
+
     boost::python::list pyModeList;
 
-    unsigned long i;
-    for (i = 0; i < modeCnt; i++)
+    size_t i;
+    for (i = 0; i < modeList.size(); i++)
     {
         pyModeList.append(modeList[i]);
     }
@@ -374,8 +990,11 @@ boost::python::list PyHSCam_getValidCapRates(uint64_t interfaceId)
     return pyModeList;
 }
 
-uint64_t PyHSCam_getMaxRecordingTime(uint64_t interfaceId)
+unsigned long PyHSCam_getMaxFrames(uint64_t interfaceId)
 {
+    // Number of frames that fit in device memory at the current resolution
+    SdkLock sdkLock(sdkMutex);
+
     unsigned long retVal;
     unsigned long errorCode;
 
@@ -391,6 +1010,13 @@ uint64_t PyHSCam_getMaxRecordingTime(uint64_t interfaceId)
     {
         throw CamRuntimeError("Failed to retrieve max possible frames.", errorCode);
     }
+    return nFrames;
+}
+
+uint64_t PyHSCam_getMaxRecordingTime(uint64_t interfaceId)
+{
+    unsigned long nFrames;
+    nFrames = PyHSCam_getMaxFrames(interfaceId);
 
     unsigned long currentCapRate;
     currentCapRate = PyHSCam_getCurrentCapRate(interfaceId);
@@ -402,23 +1028,12 @@ uint64_t PyHSCam_getMaxRecordingTime(uint64_t interfaceId)
 
 void PyHSCam_setCapRate(uint64_t interfaceId, unsigned long capRate)
 {
-    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+    SdkLock sdkLock(sdkMutex);
 
-    boost::python::list pyModeList;
-    pyModeList = PyHSCam_getValidCapRates(interfaceId);
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
 
-    long modeCnt = boost::python::len(pyModeList);
-    long i;
-    unsigned long mode;
-    for (i = 0; i < modeCnt; i++)
-    {
-        mode = boost::python::extract<unsigned long>(pyModeList[i]);
-        if (mode == capRate)
-        {
-            break;
-        }
-    }
-    if (i == modeCnt)
+    std::vector<unsigned long> modeList = PyHSCam_readValidCapRates(interfaceId);
+    if (std::find(modeList.begin(), modeList.end(), capRate) == modeList.end())
     {
         throw CamRuntimeError("The requested capture rate is not valid!");
     }
@@ -433,38 +1048,382 @@ void PyHSCam_setCapRate(uint64_t interfaceId, unsigned long capRate)
     {
         throw CamRuntimeError("Setting new record rate failed!", errorCode);
     }
+    PyHSCam_rememberDeviceSettings(interfaceId, 0, 0, capRate);
 }
 
-PyObject * PyHSCam_captureLiveImage(uint64_t interfaceId)
+// Dark-frame and flat-field correction
+// Reference frames are kept per device and resolution. When enabled, every frame returned
+// by captureLiveImage() and getImageFromMemory() is corrected as
+//     out = saturate((raw - dark) * gain)
+// where gain = mean(flat - dark) / (flat - dark) is stored per pixel in 4.12 fixed point.
+// 8-bit output is corrected in place; 16-bit output keeps 8 fractional bits (out * 256).
+#define CORRECTION_GAIN_SHIFT 12
+#define CORRECTION_GAIN_ONE (1 << CORRECTION_GAIN_SHIFT)
+
+struct CorrectionFrames
 {
-    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+    std::vector<uint8_t> dark;
+    std::vector<uint8_t> flat;      // Empty until a flat frame is captured or loaded
+    std::vector<uint16_t> gain;
+};
+
+struct CorrectionSettings
+{
+    bool enabled;
+    unsigned long outputBitDepth;
+};
+
+// Keyed by (interfaceId, width, height). reconnect() moves them to the new interfaceId.
+std::map<std::tuple<uint64_t, unsigned long, unsigned long>, CorrectionFrames> correctionFrames;
+std::map<uint64_t, CorrectionSettings> correctionSettings;
+
+
+void PyHSCam_moveCorrection(uint64_t oldInterfaceId, uint64_t newInterfaceId)
+{
+    // Hand the reference frames and settings of a device over to its new interfaceId
+    if (oldInterfaceId == newInterfaceId)
+    {
+        return;
+    }
+    std::map<std::tuple<uint64_t, unsigned long, unsigned long>, CorrectionFrames>::iterator it;
+    it = correctionFrames.lower_bound(std::make_tuple(oldInterfaceId, 0UL, 0UL));
+    while (it != correctionFrames.end() && std::get<0>(it->first) == oldInterfaceId)
+    {
+        std::tuple<uint64_t, unsigned long, unsigned long> newKey(newInterfaceId,
+                                                                    std::get<1>(it->first),
+                                                                    std::get<2>(it->first));
+        correctionFrames[newKey] = it->second;
+        it = correctionFrames.erase(it);
+    }
+
+    std::map<uint64_t, CorrectionSettings>::iterator settingsIt = correctionSettings.find(oldInterfaceId);
+    if (settingsIt != correctionSettings.end())
+    {
+        correctionSettings[newInterfaceId] = settingsIt->second;
+        correctionSettings.erase(settingsIt);
+    }
+}
+
+
+void PyHSCam_readLiveImage(uint64_t interfaceId, const PixelFormat & format, char * imageBuf)
+{
+    SdkLock sdkLock(sdkMutex);
 
-    char * imageBuf;
-    unsigned long imgWidth;
-    unsigned long imgHeight;
-    unsigned long errorCode;
     unsigned long retVal;
+    unsigned long errorCode;
+
+    retVal = PDC_GetLiveImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                    format.bitDepth,
+                                    imageBuf,
+                                    &errorCode);
 
-    boost::python::tuple imgResolution = PyHSCam_getCurrentResolution(interfaceId);
-    imgWidth = boost::python::extract<unsigned long>(imgResolution[0]);
-    imgHeight = boost::python::extract<unsigned long>(imgResolution[1]);
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to retrive live image!", errorCode);
+    }
+}
 
-    uint32_t imgBufSize;
+CorrectionFrames & PyHSCam_getCorrectionFramesForCurrentResolution(uint64_t interfaceId, size_t & frameSize)
+{
+    // Returns the (possibly new, empty) reference frames for the current resolution.
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    if (format.bitDepth != 8)
+    {
+        throw CamRuntimeError("Dark/flat correction requires an 8-bit transfer bit depth.");
+    }
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+    frameSize = format.frameSize(resolution.width, resolution.height);
+    return correctionFrames[std::make_tuple(interfaceId, resolution.width, resolution.height)];
+}
 
-    // TODO: Add support for 16-bit color images
-    if (PyHSCam_isDeviceMonochromatic(interfaceId))
+void PyHSCam_averageLiveImages(uint64_t interfaceId, unsigned long nFrames, size_t frameSize,
+                                std::vector<uint8_t> & average)
+{
+    if (nFrames == 0)
+    {
+        throw CamRuntimeError("At least one frame is required to build a reference frame.");
+    }
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    std::vector<char> imageBuf(frameSize);
+    std::vector<uint32_t> sum(frameSize, 0);
+    unsigned long frameN;
+    size_t i;
+    for (frameN = 0; frameN < nFrames; frameN++)
+    {
+        PyHSCam_readLiveImage(interfaceId, format, &imageBuf[0]);
+        for (i = 0; i < frameSize; i++)
+        {
+            sum[i] += (uint8_t)imageBuf[i];
+        }
+    }
+
+    average.resize(frameSize);
+    for (i = 0; i < frameSize; i++)
+    {
+        average[i] = (uint8_t)((sum[i] + nFrames / 2) / nFrames);
+    }
+}
+
+void PyHSCam_updateCorrectionGain(CorrectionFrames & frames)
+{
+    // Derive the per-pixel gain from the dark and flat frames. Pixels where the flat
+    // frame is no brighter than the dark frame are passed through with unity gain.
+    size_t frameSize = frames.dark.size();
+    frames.gain.assign(frameSize, CORRECTION_GAIN_ONE);
+    if (frames.flat.empty())
+    {
+        return;
+    }
+
+    // The mean only covers pixels that get a gain, so dead pixels don't bias it low
+    uint64_t signalSum = 0;
+    size_t signalCount = 0;
+    size_t i;
+    for (i = 0; i < frameSize; i++)
+    {
+        if (frames.flat[i] > frames.dark[i])
+        {
+            signalSum += frames.flat[i] - frames.dark[i];
+            signalCount++;
+        }
+    }
+    if (signalCount == 0)
+    {
+        return;
+    }
+    double meanSignal = (double)signalSum / (double)signalCount;
+
+    for (i = 0; i < frameSize; i++)
+    {
+        if (frames.flat[i] > frames.dark[i])
+        {
+            double gain = meanSignal * CORRECTION_GAIN_ONE / (double)(frames.flat[i] - frames.dark[i]);
+            frames.gain[i] = (uint16_t)((gain > 65535.0) ? 65535.0 : gain + 0.5);
+        }
+    }
+}
+
+void PyHSCam_captureDarkFrame(uint64_t interfaceId, unsigned long nFrames)
+{
+    size_t frameSize;
+    CorrectionFrames & frames = PyHSCam_getCorrectionFramesForCurrentResolution(interfaceId, frameSize);
+    PyHSCam_averageLiveImages(interfaceId, nFrames, frameSize, frames.dark);
+    PyHSCam_updateCorrectionGain(frames);
+}
+
+void PyHSCam_captureFlatFrame(uint64_t interfaceId, unsigned long nFrames)
+{
+    size_t frameSize;
+    CorrectionFrames & frames = PyHSCam_getCorrectionFramesForCurrentResolution(interfaceId, frameSize);
+    if (frames.dark.empty())
+    {
+        throw CamRuntimeError("A dark frame must be captured or loaded before the flat frame.");
+    }
+    PyHSCam_averageLiveImages(interfaceId, nFrames, frameSize, frames.flat);
+    PyHSCam_updateCorrectionGain(frames);
+}
+
+bool PyHSCam_copyFrameBuffer(boost::python::object obj, size_t frameSize, std::vector<uint8_t> & frame)
+{
+    // Copy a frame out of any C-contiguous buffer (bytes, bytearray, numpy array, ...).
+    // Returns false if it isn't frameSize bytes long. str has no buffer so it is rejected
+    // with a TypeError rather than being encoded.
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj.ptr(), &view, PyBUF_C_CONTIGUOUS) != 0)
+    {
+        boost::python::throw_error_already_set();
+    }
+    bool sizeMatches = ((size_t)view.len == frameSize);
+    if (sizeMatches)
+    {
+        const uint8_t * data = (const uint8_t *)view.buf;
+        frame.assign(data, data + frameSize);
+    }
+    PyBuffer_Release(&view);
+    return sizeMatches;
+}
+
+void PyHSCam_loadCorrectionFrames(uint64_t interfaceId, boost::python::object dark, boost::python::object flat)
+{
+    // dark and flat are buffers (bytes, numpy arrays, ...) in the same layout as captured
+    // images. flat may be None for dark subtraction only.
+    size_t frameSize;
+    CorrectionFrames & frames = PyHSCam_getCorrectionFramesForCurrentResolution(interfaceId, frameSize);
+
+    std::vector<uint8_t> darkFrame;
+    if (!PyHSCam_copyFrameBuffer(dark, frameSize, darkFrame))
+    {
+        throw CamRuntimeError("Dark frame size doesn't match the current resolution.");
+    }
+    std::vector<uint8_t> flatFrame;
+    if (!flat.is_none() && !PyHSCam_copyFrameBuffer(flat, frameSize, flatFrame))
     {
-        imgBufSize = imgWidth * imgHeight;
+        throw CamRuntimeError("Flat frame size doesn't match the current resolution.");
     }
-    else  // RGB Color
+
+    frames.dark.swap(darkFrame);
+    frames.flat.swap(flatFrame);
+    PyHSCam_updateCorrectionGain(frames);
+}
+
+boost::python::tuple PyHSCam_getCorrectionFrames(uint64_t interfaceId)
+{
+    // Returns (dark, flat) for the current resolution so they can be saved and loaded later.
+    size_t frameSize;
+    CorrectionFrames & frames = PyHSCam_getCorrectionFramesForCurrentResolution(interfaceId, frameSize);
+    if (frames.dark.empty())
+    {
+        throw CamRuntimeError("No correction frames exist for the current resolution.");
+    }
+
+    boost::python::object pyDark(boost::python::handle<>(
+        PyBytes_FromStringAndSize((const char *)&frames.dark[0], frames.dark.size())));
+    if (frames.flat.empty())
+    {
+        return boost::python::make_tuple(pyDark, boost::python::object());
+    }
+    boost::python::object pyFlat(boost::python::handle<>(
+        PyBytes_FromStringAndSize((const char *)&frames.flat[0], frames.flat.size())));
+    return boost::python::make_tuple(pyDark, pyFlat);
+}
+
+void PyHSCam_setCorrection(uint64_t interfaceId, bool enabled, unsigned long outputBitDepth)
+{
+    if (outputBitDepth != 8 && outputBitDepth != 16)
+    {
+        throw CamRuntimeError("Corrected output bit depth must be 8 or 16.");
+    }
+    CorrectionSettings settings;
+    settings.enabled = enabled;
+    settings.outputBitDepth = outputBitDepth;
+    correctionSettings[interfaceId] = settings;
+}
+
+void PyHSCam_correct8(const uint8_t * raw, const uint8_t * dark, const uint16_t * gain,
+                        uint8_t * out, size_t n)
+{
+    // out = saturate8(((raw -sat dark) * gain) >> 12). raw and out may alias.
+    size_t i = 0;
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_subs_epu8(_mm_loadu_si128((const __m128i *)(raw + i)),
+                                    _mm_loadu_si128((const __m128i *)(dark + i)));
+        __m128i vLo = _mm_unpacklo_epi8(v, zero);
+        __m128i vHi = _mm_unpackhi_epi8(v, zero);
+        __m128i gLo = _mm_loadu_si128((const __m128i *)(gain + i));
+        __m128i gHi = _mm_loadu_si128((const __m128i *)(gain + i + 8));
+        // The 24-bit product is split across mullo/mulhi; reassemble bits 12..27
+        __m128i rLo = _mm_or_si128(_mm_srli_epi16(_mm_mullo_epi16(vLo, gLo), CORRECTION_GAIN_SHIFT),
+                                    _mm_slli_epi16(_mm_mulhi_epu16(vLo, gLo), 16 - CORRECTION_GAIN_SHIFT));
+        __m128i rHi = _mm_or_si128(_mm_srli_epi16(_mm_mullo_epi16(vHi, gHi), CORRECTION_GAIN_SHIFT),
+                                    _mm_slli_epi16(_mm_mulhi_epu16(vHi, gHi), 16 - CORRECTION_GAIN_SHIFT));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(rLo, rHi));
+    }
+    for (; i < n; i++)
+    {
+        uint32_t v = (raw[i] > dark[i]) ? (raw[i] - dark[i]) : 0;
+        uint32_t r = (v * gain[i]) >> CORRECTION_GAIN_SHIFT;
+        out[i] = (uint8_t)((r > 255) ? 255 : r);
+    }
+}
+
+void PyHSCam_correct16(const uint8_t * raw, const uint8_t * dark, const uint16_t * gain,
+                        uint16_t * out, size_t n)
+{
+    // out = saturate16(((raw -sat dark) * gain) >> 4), i.e. the corrected value in 8.8 fixed point.
+#define CORRECTION_OUT16_SHIFT (CORRECTION_GAIN_SHIFT - 8)
+    size_t i = 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i hiLimit = _mm_set1_epi16((1 << CORRECTION_OUT16_SHIFT) - 1);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_subs_epu8(_mm_loadu_si128((const __m128i *)(raw + i)),
+                                    _mm_loadu_si128((const __m128i *)(dark + i)));
+        __m128i halves[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+        int h;
+        for (h = 0; h < 2; h++)
+        {
+            __m128i g = _mm_loadu_si128((const __m128i *)(gain + i + h * 8));
+            __m128i lo = _mm_mullo_epi16(halves[h], g);
+            __m128i hi = _mm_mulhi_epu16(halves[h], g);
+            __m128i r = _mm_or_si128(_mm_srli_epi16(lo, CORRECTION_OUT16_SHIFT),
+                                        _mm_slli_epi16(hi, 16 - CORRECTION_OUT16_SHIFT));
+            // hi < 256, so a signed compare is safe. Saturate where bits would be lost.
+            r = _mm_or_si128(r, _mm_cmpgt_epi16(hi, hiLimit));
+            _mm_storeu_si128((__m128i *)(out + i + h * 8), r);
+        }
+    }
+    for (; i < n; i++)
+    {
+        uint32_t v = (raw[i] > dark[i]) ? (raw[i] - dark[i]) : 0;
+        uint32_t r = (v * gain[i]) >> CORRECTION_OUT16_SHIFT;
+        out[i] = (uint16_t)((r > 65535) ? 65535 : r);
+    }
+}
+
+PyObject * PyHSCam_imageToBytes(uint64_t interfaceId, char * imageBuf, const Resolution & resolution,
+                                uint32_t imageBufSize)
+{
+    // Convert a downloaded image to PyBytes, applying dark/flat correction if it is enabled
+    // and reference frames exist for this resolution.
+    std::map<uint64_t, CorrectionSettings>::const_iterator settingsIt = correctionSettings.find(interfaceId);
+    if (settingsIt == correctionSettings.end() || !settingsIt->second.enabled)
+    {
+        return PyBytes_FromStringAndSize(imageBuf, imageBufSize);
+    }
+    if (PyHSCam_getPixelFormat(interfaceId).bitDepth != 8)
+    {
+        throw CamRuntimeError("Dark/flat correction requires an 8-bit transfer bit depth.");
+    }
+    std::map<std::tuple<uint64_t, unsigned long, unsigned long>, CorrectionFrames>::const_iterator framesIt;
+    framesIt = correctionFrames.find(std::make_tuple(interfaceId, resolution.width, resolution.height));
+    if (framesIt == correctionFrames.end() || framesIt->second.dark.size() != imageBufSize)
+    {
+        throw CamRuntimeError("Correction is enabled but no reference frames exist for the current resolution.");
+    }
+    const CorrectionFrames & frames = framesIt->second;
+
+    if (settingsIt->second.outputBitDepth == 8)
     {
-        imgBufSize = imgWidth * imgHeight * 3;
+        PyHSCam_correct8((uint8_t *)imageBuf, &frames.dark[0], &frames.gain[0],
+                            (uint8_t *)imageBuf, imageBufSize);
+        return PyBytes_FromStringAndSize(imageBuf, imageBufSize);
     }
+
+    // Write 16-bit output straight into the bytes object
+    PyObject * pyImageBuf = PyBytes_FromStringAndSize(NULL, imageBufSize * sizeof(uint16_t));
+    if (pyImageBuf == NULL)
+    {
+        boost::python::throw_error_already_set();
+    }
+    PyHSCam_correct16((uint8_t *)imageBuf, &frames.dark[0], &frames.gain[0],
+                        (uint16_t *)PyBytes_AS_STRING(pyImageBuf), imageBufSize);
+    return pyImageBuf;
+}
+
+PyObject * PyHSCam_captureLiveImage(uint64_t interfaceId)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+
+    char * imageBuf;
+    unsigned long errorCode;
+    unsigned long retVal;
+
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    uint32_t imgBufSize = format.frameSize(resolution.width, resolution.height);
     imageBuf = (char *)malloc(imgBufSize);
 
     retVal = PDC_GetLiveImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
                                     IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                    8,  // Assume 8-bit color depth
+                                    format.bitDepth,
                                     imageBuf,
                                     &errorCode);
 
@@ -474,7 +1433,16 @@ PyObject * PyHSCam_captureLiveImage(uint64_t interfaceId)
         throw CamRuntimeError("Failed to retrive live image!", errorCode);
     }
 
-    PyObject * pyImageBuf = PyBytes_FromStringAndSize(imageBuf, imgBufSize);
+    PyObject * pyImageBuf;
+    try
+    {
+        pyImageBuf = PyHSCam_imageToBytes(interfaceId, imageBuf, resolution, imgBufSize);
+    }
+    catch (...)
+    {
+        free(imageBuf);
+        throw;
+    }
     free(imageBuf);
 
     return pyImageBuf;
@@ -483,6 +1451,8 @@ PyObject * PyHSCam_captureLiveImage(uint64_t interfaceId)
 
 PDC_FRAME_INFO PyHSCam_getMemoryFrameInfo(uint64_t interfaceId)
 {
+    SdkLock sdkLock(sdkMutex);
+
     unsigned long retVal;
     unsigned long errorCode;
     PDC_FRAME_INFO frameInfo;
@@ -493,323 +1463,2755 @@ PDC_FRAME_INFO PyHSCam_getMemoryFrameInfo(uint64_t interfaceId)
                                 "This should never happen.");
     }
 
-    retVal = PDC_GetMemFrameInfo(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                    &frameInfo,
-                                    &errorCode);
-    if (retVal == PDC_FAILED)
+    retVal = PDC_GetMemFrameInfo(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                    &frameInfo,
+                                    &errorCode);
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to retrieve frame info!", errorCode);
+    }
+
+    return frameInfo;
+}
+
+
+bool PyHSCam_isFrameRangeRecorded(const PDC_FRAME_INFO & frameInfo, unsigned long startFrame,
+                                    unsigned long frameCount)
+{
+    // Memory frames are numbered from 0 at m_nStart, the oldest recorded frame, whatever the
+    // trigger mode; frame n is SDK frame m_nStart + n. Checked without forming
+    // startFrame + frameCount so that it can't wrap.
+    unsigned long recordedFrames = (frameInfo.m_nRecordedFrames > 0) ? frameInfo.m_nRecordedFrames : 0;
+    return frameCount <= recordedFrames && startFrame <= recordedFrames - frameCount;
+}
+
+
+long PyHSCam_getMemoryFrameCount(uint64_t interfaceId)
+{
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+
+    PDC_FRAME_INFO frameInfo;
+    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+
+    return frameInfo.m_nRecordedFrames;
+}
+
+
+PyObject * PyHSCam_getImageFromMemory(uint64_t interfaceId, unsigned long frameN)
+{
+    // The mode must be set to PDC_STATUS_PLAYBACK to read from memory
+    SdkLock sdkLock(sdkMutex);
+
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+    clock_t startTime = clock();
+
+    PDC_FRAME_INFO frameInfo;
+    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+
+    if (!PyHSCam_isFrameRangeRecorded(frameInfo, frameN, 1))
+    {
+        throw CamRuntimeError("Failed to retrieve image - frameN is out of range for recorded images.");
+    }
+
+    char * imageBuf;
+    uint32_t imageBufSize;
+
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    imageBufSize = format.frameSize(resolution.width, resolution.height);
+
+    imageBuf = (char *)malloc(imageBufSize);
+
+    retVal = PDC_GetMemImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                    frameInfo.m_nStart + frameN,
+                                    format.bitDepth,
+                                    imageBuf,               // Output
+                                    &errorCode);            // Output
+
+    if (retVal == PDC_FAILED)
+    {
+        free(imageBuf);
+        throw CamRuntimeError("Failed to retrieve image from memory!", errorCode);
+    }
+
+    PyObject * pyImageBuf;
+    try
+    {
+        pyImageBuf = PyHSCam_imageToBytes(interfaceId, imageBuf, resolution, imageBufSize);
+    }
+    catch (...)
+    {
+        free(imageBuf);
+        throw;
+    }
+    free(imageBuf);
+
+    return pyImageBuf;
+}
+
+Resolution PyHSCam_getResolution(uint64_t interfaceId)
+{
+    // Plain C++ version of getCurrentResolution() - safe to call without the GIL.
+    SdkLock sdkLock(sdkMutex);
+
+    Resolution resolution;
+    unsigned long errorCode;
+    unsigned long retVal;
+
+    retVal = PDC_GetResolution(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                &resolution.width,      // Output
+                                &resolution.height,     // Output
+                                &errorCode);            // Output
+
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to read current resolution!", errorCode);
+    }
+
+    return resolution;
+}
+
+boost::python::tuple PyHSCam_getCurrentResolution(uint64_t interfaceId)
+{
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+
+    return boost::python::make_tuple(resolution.width, resolution.height);
+}
+
+void PyHSCam_setResolution(uint64_t interfaceId, unsigned long width, unsigned long height)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    if (PyHSCam_hasLiveSubscribers(interfaceId))
+    {
+        throw CamRuntimeError("Cannot change the resolution while a frame server client "
+                                "is subscribed to live images.");
+    }
+
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+
+    retVal = PDC_SetResolution(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                width,
+                                height,
+                                &errorCode);    // Output
+
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to set resolution!", errorCode);
+    }
+    PyHSCam_rememberDeviceSettings(interfaceId, width, height, 0);
+}
+
+boost::python::list PyHSCam_getAllValidResolutions(uint64_t interfaceId)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+
+    unsigned long resList[PDC_MAX_LIST_NUMBER];
+    unsigned long resListSize;
+
+    retVal = PDC_GetResolutionList(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                    &resListSize,       // Output
+                                    &resList[0],        // Output
+                                    &errorCode);        // Output
+
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to retrieve list of valid resolutions!", errorCode);
+    }
+
+    boost::python::list pyResList;
+
+    unsigned long i;
+    for (i = 0; i < resListSize; i++)
+    {
+        unsigned long width  = (resList[i] & 0xffff0000) >> 16;
+        unsigned long height = (resList[i] & 0x0000ffff);
+        pyResList.append(boost::python::make_tuple(width, height));
+    }
+
+    return pyResList;
+}
+
+bool PyHSCam_isDeviceMonochromatic(uint64_t interfaceId)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+    char colorMode;
+
+    retVal = PDC_GetColorType(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                &colorMode,         // Output
+                                &errorCode);        // Output
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to retrieve device color mode!", errorCode);
+    }
+
+    if (colorMode == PDC_COLORTYPE_MONO)
+    {
+        return true;
+    }
+    return false;
+}
+
+unsigned long PyHSCam_getStatus(uint64_t interfaceId)
+{
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+    unsigned long deviceStatus;
+    retVal = PDC_GetStatus(IFACE_ID_GET_DEV_NUM(interfaceId),
+                            &deviceStatus,
+                            &errorCode);
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Error while retrieving device status!", errorCode);
+    }
+    return deviceStatus;
+}
+
+
+uint64_t PyHSCam_elapsedMs(std::chrono::steady_clock::time_point startTime)
+{
+    // Wall-clock milliseconds since startTime, for status polling timeouts
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - startTime).count();
+}
+
+void PyHSCam_armRecording(uint64_t interfaceId, unsigned long triggerMode, unsigned long afterFrames)
+{
+    // Put the device into record-ready with the given PDC_TRIGGER_* mode. Except in start
+    // mode, endless recording begins immediately so that frames before the trigger are kept.
+    // afterFrames is only used by PDC_TRIGGER_MANUAL.
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long deviceStatus;
+
+    deviceStatus = PyHSCam_getStatus(interfaceId);
+    if (deviceStatus != PDC_STATUS_LIVE)
+    {
+        throw CamRuntimeError("Device attempted to begin recording while not in LIVE mode. "
+                                "This should never happen.");
+    }
+
+    unsigned long errorCode;
+    unsigned long retVal;
+
+    retVal = PDC_SetTriggerMode(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                triggerMode,
+                                afterFrames,    // nAFrames: Frames after the trigger in manual mode
+                                0,              // nRFrames: Unused outside of random modes
+                                0,              // nRCount:  Unused outside of random modes
+                                &errorCode);    // Output
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to set trigger mode!", errorCode);
+    }
+
+    retVal = PDC_SetRecReady(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                &errorCode);     // Output
+
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to set record to ready!", errorCode);
+    }
+
+    // Timeout in ms. This check confirms that the camera is operating in record mode
+    // before we begin recording.
+#define STATUS_CHECK_TIMEOUT 1000
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    bool actionCompleted = false;
+    while (PyHSCam_elapsedMs(startTime) < STATUS_CHECK_TIMEOUT)
+    {
+        deviceStatus = PyHSCam_getStatus(interfaceId);
+        if ((deviceStatus == PDC_STATUS_RECREADY) ||
+            (deviceStatus == PDC_STATUS_REC))
+        {
+            // The device is ready for recording
+            actionCompleted = true;
+            break;
+        }
+    }
+    if (!actionCompleted)
+    {
+        throw CamRuntimeError("Function timed out while waiting for device to enter record-ready state.");
+    }
+
+    if (triggerMode == PDC_TRIGGER_START)
+    {
+        // The trigger itself starts the recording
+        return;
+    }
+
+    // Start the recording
+    retVal = PDC_SetEndless(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                &errorCode);
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Device trigger in (begin recording) failed!", errorCode);
+    }
+}
+
+void PyHSCam_beginRecording(uint64_t interfaceId)
+{
+    // Begin recording endlessly (or until we run out of memory).
+    // This function does not handle exiting recording mode or halting recording.
+    PyHSCam_armRecording(interfaceId, PDC_TRIGGER_END, 0);
+}
+
+void PyHSCam_haltRecording(uint64_t interfaceId)
+{
+    // Halt recording forcibly by setting the mode to "LIVE"
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+
+    unsigned long deviceStatus;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    bool actionCompleted = false;
+    while (PyHSCam_elapsedMs(startTime) < STATUS_CHECK_TIMEOUT)
+    {
+        deviceStatus = PyHSCam_getStatus(interfaceId);
+        if (deviceStatus == PDC_STATUS_LIVE)
+        {
+            // The device is ready for recording
+            actionCompleted = true;
+            break;
+        }
+    }
+    if (!actionCompleted)
+    {
+        throw CamRuntimeError("Function timed out while waiting for device to enter LIVE mode.");
+    }
+}
+
+
+void PyHSCam_recordBlocking(uint64_t interfaceId, uint64_t duration)
+{
+    unsigned long deviceStatus;
+
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    // Add 5 ms to account for the time between now and when the recording actually starts.
+    // (Not that precision is too important, but I think it looks nicer if the timer is accurate)
+    // Starting the timer after PyHSCam_beginRecording() is called introduces ~200 ms of extra
+    // uncounted recording time.
+    duration += 5;
+    uint64_t maxTime = PyHSCam_getMaxRecordingTime(interfaceId);
+    duration = (duration < maxTime) ? duration : maxTime;
+    PyHSCam_beginRecording(interfaceId);
+    uint64_t elapsed = 0;
+    // Wait for recording to finish
+    do
+    {
+        deviceStatus = PyHSCam_getStatus(interfaceId);
+        if ((deviceStatus != PDC_STATUS_ENDLESS) &&
+            (deviceStatus != PDC_STATUS_REC))
+        {
+            // Recording has finished.
+            break;
+        }
+        elapsed = PyHSCam_elapsedMs(startTime);
+    } while (elapsed < duration);
+    PyHSCam_haltRecording(interfaceId);
+    if (elapsed >= maxTime)
+    {
+        throw CamRuntimeError("Recording exceeded available memory!");
+    }
+}
+
+
+// Streaming temporal reductions
+// reduceMemory() downloads frames one at a time and folds them into per-pixel accumulators
+// so that memory use is proportional to one frame rather than the whole recording.
+// The next frame is downloaded while worker threads reduce the current one; each worker
+// owns a fixed stripe of the image.
+#define REDUCE_OP_MAX (1 << 0)
+#define REDUCE_OP_MEAN (1 << 1)
+#define REDUCE_OP_STD (1 << 2)
+#define REDUCE_OP_ARGMAX (1 << 3)
+#define REDUCE_MAX_THREADS 16
+
+struct ReductionState
+{
+    unsigned long ops;
+    size_t sampleCount;
+    std::vector<uint8_t> maxImg;        // One Sample per sample
+    std::vector<uint32_t> argmaxImg;
+    std::vector<uint64_t> sumImg;       // Used for the mean when std isn't requested
+    std::vector<float> meanImg;         // Welford running mean
+    std::vector<float> m2Img;           // Welford sum of squared differences
+};
+
+typedef void (*ReduceStripeFn)(ReductionState & state, const uint8_t * frame, uint32_t frameN,
+                                unsigned long frameIdx, size_t begin, size_t end);
+
+template <typename Sample>
+void PyHSCam_reduceMax(const Sample * frame, Sample * maxImg, uint32_t * argmaxImg, uint32_t frameN,
+                        unsigned long frameIdx, size_t begin, size_t end)
+{
+    // Running max and (optionally) the frame number of each sample's first maximum.
+    size_t i;
+    for (i = begin; i < end; i++)
+    {
+        if (frame[i] > maxImg[i] || frameIdx == 0)
+        {
+            maxImg[i] = frame[i];
+            if (argmaxImg)
+            {
+                argmaxImg[i] = frameN;
+            }
+        }
+    }
+}
+
+template <>
+void PyHSCam_reduceMax<uint8_t>(const uint8_t * frame, uint8_t * maxImg, uint32_t * argmaxImg, uint32_t frameN,
+                                unsigned long frameIdx, size_t begin, size_t end)
+{
+    // SSE2 version of the above for 8-bit samples
+    const __m128i frameNVec = _mm_set1_epi32(frameN);
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(frame + i));
+        __m128i oldMax = _mm_loadu_si128((const __m128i *)(maxImg + i));
+        __m128i newMax = _mm_max_epu8(v, oldMax);
+        _mm_storeu_si128((__m128i *)(maxImg + i), newMax);
+        if (argmaxImg)
+        {
+            // Lanes where the new sample is strictly greater take the new frame number,
+            // so ties keep the earliest frame. The first frame always sets it.
+            __m128i greater = _mm_andnot_si128(_mm_cmpeq_epi8(newMax, oldMax), _mm_set1_epi8(-1));
+            if (frameIdx == 0)
+            {
+                greater = _mm_set1_epi8(-1);
+            }
+            __m128i g16Lo = _mm_unpacklo_epi8(greater, greater);
+            __m128i g16Hi = _mm_unpackhi_epi8(greater, greater);
+            __m128i masks[4] = { _mm_unpacklo_epi16(g16Lo, g16Lo), _mm_unpackhi_epi16(g16Lo, g16Lo),
+                                 _mm_unpacklo_epi16(g16Hi, g16Hi), _mm_unpackhi_epi16(g16Hi, g16Hi) };
+            int q;
+            for (q = 0; q < 4; q++)
+            {
+                __m128i * dst = (__m128i *)(argmaxImg + i + q * 4);
+                __m128i old = _mm_loadu_si128(dst);
+                _mm_storeu_si128(dst, _mm_or_si128(_mm_and_si128(masks[q], frameNVec),
+                                                    _mm_andnot_si128(masks[q], old)));
+            }
+        }
+    }
+    for (; i < end; i++)
+    {
+        if (frame[i] > maxImg[i] || frameIdx == 0)
+        {
+            maxImg[i] = frame[i];
+            if (argmaxImg)
+            {
+                argmaxImg[i] = frameN;
+            }
+        }
+    }
+}
+
+template <class Format>
+void PyHSCam_reduceStripe(ReductionState & state, const uint8_t * frameBytes, uint32_t frameN,
+                            unsigned long frameIdx, size_t begin, size_t end)
+{
+    // Fold samples [begin, end) of frame into the accumulators. frameIdx counts frames
+    // already reduced; frameN is the memory frame number recorded for argmax.
+    typedef typename Format::Sample Sample;
+    const Sample * frame = (const Sample *)frameBytes;
+    size_t i;
+
+    if (state.ops & (REDUCE_OP_MAX | REDUCE_OP_ARGMAX))
+    {
+        PyHSCam_reduceMax<Sample>(frame,
+                                    (Sample *)&state.maxImg[0],
+                                    (state.ops & REDUCE_OP_ARGMAX) ? &state.argmaxImg[0] : NULL,
+                                    frameN,
+                                    frameIdx,
+                                    begin,
+                                    end);
+    }
+
+    if (state.ops & REDUCE_OP_STD)
+    {
+        // Welford's online algorithm
+        float * meanImg = &state.meanImg[0];
+        float * m2Img = &state.m2Img[0];
+        const float invN = 1.0f / (float)(frameIdx + 1);
+        for (i = begin; i < end; i++)
+        {
+            float x = (float)frame[i];
+            float delta = x - meanImg[i];
+            meanImg[i] += delta * invN;
+            m2Img[i] += delta * (x - meanImg[i]);
+        }
+    }
+    else if (state.ops & REDUCE_OP_MEAN)
+    {
+        uint64_t * sumImg = &state.sumImg[0];
+        for (i = begin; i < end; i++)
+        {
+            sumImg[i] += frame[i];
+        }
+    }
+}
+
+struct ReduceStripeSelector
+{
+    typedef ReduceStripeFn Result;
+    template <class Format>
+    Result run()
+    {
+        return &PyHSCam_reduceStripe<Format>;
+    }
+};
+
+class ReductionPool
+{
+    // Persistent worker threads which each reduce one stripe of the current frame.
+private:
+    ReductionState & state;
+    ReduceStripeFn reduceStripe;
+    std::vector<std::thread> workers;
+    unsigned long threadCount;
+    std::mutex mutex;
+    std::condition_variable startCv;
+    std::condition_variable doneCv;
+    unsigned long generation;
+    unsigned long pending;
+    bool quit;
+    const uint8_t * frame;
+    uint32_t frameN;
+    unsigned long frameIdx;
+
+    void workerLoop(unsigned long workerIdx)
+    {
+        // Round the share up (not down) so the stripes always cover every sample
+        size_t stripe = ((state.sampleCount + threadCount - 1) / threadCount + 15) & ~(size_t)15;
+        size_t begin = workerIdx * stripe;
+        size_t end = begin + stripe;
+        begin = (begin < state.sampleCount) ? begin : state.sampleCount;
+        end = (end < state.sampleCount) ? end : state.sampleCount;
+
+        unsigned long seenGeneration = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                startCv.wait(lock, [&]() { return quit || generation != seenGeneration; });
+                if (quit)
+                {
+                    return;
+                }
+                seenGeneration = generation;
+            }
+            reduceStripe(state, frame, frameN, frameIdx, begin, end);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+            }
+            doneCv.notify_one();
+        }
+    }
+public:
+    ReductionPool(ReductionState & state, ReduceStripeFn reduceStripe, unsigned long threadCount)
+        : state(state), reduceStripe(reduceStripe), threadCount(threadCount), generation(0),
+          pending(0), quit(false), frame(NULL), frameN(0), frameIdx(0)
+    {
+        unsigned long i;
+        for (i = 0; i < threadCount; i++)
+        {
+            workers.push_back(std::thread(&ReductionPool::workerLoop, this, i));
+        }
+    }
+    ~ReductionPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        startCv.notify_all();
+        size_t i;
+        for (i = 0; i < workers.size(); i++)
+        {
+            workers[i].join();
+        }
+    }
+    void dispatch(const uint8_t * newFrame, uint32_t newFrameN, unsigned long newFrameIdx)
+    {
+        // Start reducing newFrame on all workers and return immediately.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            frame = newFrame;
+            frameN = newFrameN;
+            frameIdx = newFrameIdx;
+            pending = threadCount;
+            generation++;
+        }
+        startCv.notify_all();
+    }
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCv.wait(lock, [&]() { return pending == 0; });
+    }
+};
+
+boost::python::dict PyHSCam_reduceMemory(uint64_t interfaceId, boost::python::list ops,
+                                            unsigned long startFrame, unsigned long frameCount)
+{
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+
+    ReductionState state;
+    state.ops = 0;
+    long opCnt = boost::python::len(ops);
+    long opIdx;
+    for (opIdx = 0; opIdx < opCnt; opIdx++)
+    {
+        std::string op = boost::python::extract<std::string>(ops[opIdx]);
+        if (op == "max")
+        {
+            state.ops |= REDUCE_OP_MAX;
+        }
+        else if (op == "mean")
+        {
+            state.ops |= REDUCE_OP_MEAN;
+        }
+        else if (op == "std")
+        {
+            state.ops |= REDUCE_OP_STD;
+        }
+        else if (op == "argmax")
+        {
+            state.ops |= REDUCE_OP_ARGMAX;
+        }
+        else
+        {
+            throw CamRuntimeError("Unknown reduction. Valid reductions are max, mean, std and argmax.");
+        }
+    }
+    if (state.ops == 0 || frameCount == 0)
+    {
+        throw CamRuntimeError("reduceMemory requires at least one reduction and one frame.");
+    }
+
+    PDC_FRAME_INFO frameInfo;
+    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+    if (!PyHSCam_isFrameRangeRecorded(frameInfo, startFrame, frameCount))
+    {
+        throw CamRuntimeError("Failed to reduce images - frame range is out of range for recorded images.");
+    }
+
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    size_t frameSize = format.frameSize(resolution.width, resolution.height);
+    state.sampleCount = format.sampleCount(resolution.width, resolution.height);
+
+    if (state.ops & (REDUCE_OP_MAX | REDUCE_OP_ARGMAX))
+    {
+        state.maxImg.assign(frameSize, 0);
+    }
+    if (state.ops & REDUCE_OP_ARGMAX)
+    {
+        state.argmaxImg.assign(state.sampleCount, 0);
+    }
+    if (state.ops & REDUCE_OP_STD)
+    {
+        state.meanImg.assign(state.sampleCount, 0.0f);
+        state.m2Img.assign(state.sampleCount, 0.0f);
+    }
+    else if (state.ops & REDUCE_OP_MEAN)
+    {
+        state.sumImg.assign(state.sampleCount, 0);
+    }
+
+    unsigned long threadCount = std::thread::hardware_concurrency();
+    threadCount = (threadCount == 0) ? 1 : threadCount;
+    threadCount = (threadCount > REDUCE_MAX_THREADS) ? REDUCE_MAX_THREADS : threadCount;
+
+    ReduceStripeSelector selector;
+    ReduceStripeFn reduceStripe = PyHSCam_dispatchPixelFormat(format.id, selector);
+
+    // Double buffered: one frame is downloaded while the other is reduced
+    std::vector<uint8_t> frameBufs[2];
+    frameBufs[0].resize(frameSize);
+    frameBufs[1].resize(frameSize);
+
+    {
+        // Only C++ buffers are touched until the results are converted below
+        GilRelease gilRelease;
+        ReductionPool pool(state, reduceStripe, threadCount);
+
+        unsigned long retVal = PDC_FAILED;
+        unsigned long errorCode;
+        unsigned long frameIdx;
+        for (frameIdx = 0; frameIdx <= frameCount; frameIdx++)
+        {
+            // Download frame frameIdx while the workers reduce frame frameIdx - 1
+            if (frameIdx < frameCount)
+            {
+                SdkLock sdkLock(sdkMutex);
+                retVal = PDC_GetMemImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                                IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                                frameInfo.m_nStart + startFrame + frameIdx,
+                                                format.bitDepth,
+                                                &frameBufs[frameIdx % 2][0],    // Output
+                                                &errorCode);                    // Output
+            }
+            if (frameIdx > 0)
+            {
+                pool.wait();
+            }
+            if (frameIdx == frameCount)
+            {
+                break;
+            }
+            if (retVal == PDC_FAILED)
+            {
+                throw CamRuntimeError("Failed to retrieve image from memory!", errorCode);
+            }
+            pool.dispatch(&frameBufs[frameIdx % 2][0], startFrame + frameIdx, frameIdx);
+        }
+    }
+
+    boost::python::dict results;
+    size_t i;
+    if (state.ops & REDUCE_OP_MAX)
+    {
+        results["max"] = boost::python::object(boost::python::handle<>(
+            PyBytes_FromStringAndSize((const char *)&state.maxImg[0], frameSize)));
+    }
+    if (state.ops & REDUCE_OP_ARGMAX)
+    {
+        results["argmax"] = boost::python::object(boost::python::handle<>(
+            PyBytes_FromStringAndSize((const char *)&state.argmaxImg[0], state.sampleCount * sizeof(uint32_t))));
+    }
+    if (state.ops & REDUCE_OP_MEAN)
+    {
+        if (!(state.ops & REDUCE_OP_STD))
+        {
+            state.meanImg.resize(state.sampleCount);
+            for (i = 0; i < state.sampleCount; i++)
+            {
+                state.meanImg[i] = (float)((double)state.sumImg[i] / (double)frameCount);
+            }
+        }
+        results["mean"] = boost::python::object(boost::python::handle<>(
+            PyBytes_FromStringAndSize((const char *)&state.meanImg[0], state.sampleCount * sizeof(float))));
+    }
+    if (state.ops & REDUCE_OP_STD)
+    {
+        // Population standard deviation, reusing the m2 buffer for the result
+        for (i = 0; i < state.sampleCount; i++)
+        {
+            state.m2Img[i] = sqrtf(state.m2Img[i] / (float)frameCount);
+        }
+        results["std"] = boost::python::object(boost::python::handle<>(
+            PyBytes_FromStringAndSize((const char *)&state.m2Img[0], state.sampleCount * sizeof(float))));
+    }
+
+    return results;
+}
+
+
+// Download overviews
+// With overview enabled, downloadToFile() also builds a pyramid of 2x2 box-filtered
+// thumbnails (1/2, 1/4 and 1/8 scale) and a per-frame change score in the same pass, so a
+// viewer can show a whole recording as a filmstrip without reading the full-res file.
+// Each level is written to path + ".thumbN" (N = 2, 4, 8) in the same layout as the data
+// file: frame k of the job at offset k * levelFrameSize, level dimensions are
+// (width >> level, height >> level) with odd edge rows/columns dropped.
+// path + ".scores" holds one float32 per frame: the mean absolute difference between the
+// 1/8 thumbnails of the frame and the one before it, scaled to [0, 1]. Frame 0 scores 0.
+#define OVERVIEW_LEVELS 3
+
+typedef void (*BoxFilterRowFn)(const char * srcRow0, const char * srcRow1, char * dstRow,
+                                unsigned long outWidth);
+
+template <typename Sample, unsigned long Channels>
+void PyHSCam_boxFilterRowScalar(const char * srcRow0, const char * srcRow1, char * dstRow,
+                                unsigned long outWidth)
+{
+    // Average each 2x2 block of srcRow0/srcRow1 into one pixel of dstRow (rounded)
+    const Sample * src0 = (const Sample *)srcRow0;
+    const Sample * src1 = (const Sample *)srcRow1;
+    Sample * dst = (Sample *)dstRow;
+    const unsigned long channels = Channels;
+    unsigned long col;
+    unsigned long ch;
+    for (col = 0; col < outWidth; col++)
+    {
+        for (ch = 0; ch < channels; ch++)
+        {
+            size_t left = col * 2 * channels + ch;
+            uint32_t sum = (uint32_t)src0[left] + src0[left + channels] + src1[left] + src1[left + channels];
+            dst[col * channels + ch] = (Sample)((sum + 2) >> 2);
+        }
+    }
+}
+
+template <class Format>
+void PyHSCam_boxFilterRow(const char * srcRow0, const char * srcRow1, char * dstRow,
+                            unsigned long outWidth)
+{
+    PyHSCam_boxFilterRowScalar<typename Format::Sample, Format::channels>(srcRow0, srcRow1, dstRow, outWidth);
+}
+
+template <>
+void PyHSCam_boxFilterRow<Mono8Format>(const char * srcRow0, const char * srcRow1, char * dstRow,
+                                        unsigned long outWidth)
+{
+    // SSE2: 16 source pixels of each row -> 8 output pixels. Even and odd pixels are split
+    // into 16-bit lanes so the four-sample sum can't overflow.
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    const __m128i rounding = _mm_set1_epi16(2);
+    unsigned long col = 0;
+    for (; col + 8 <= outWidth; col += 8)
+    {
+        __m128i row0 = _mm_loadu_si128((const __m128i *)(srcRow0 + col * 2));
+        __m128i row1 = _mm_loadu_si128((const __m128i *)(srcRow1 + col * 2));
+        __m128i even = _mm_add_epi16(_mm_and_si128(row0, lowBytes), _mm_and_si128(row1, lowBytes));
+        __m128i odd = _mm_add_epi16(_mm_srli_epi16(row0, 8), _mm_srli_epi16(row1, 8));
+        __m128i avg = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(even, odd), rounding), 2);
+        _mm_storel_epi64((__m128i *)(dstRow + col), _mm_packus_epi16(avg, avg));
+    }
+    if (col < outWidth)
+    {
+        PyHSCam_boxFilterRowScalar<uint8_t, 1>(srcRow0 + col * 2, srcRow1 + col * 2,
+                                                dstRow + col, outWidth - col);
+    }
+}
+
+template <>
+void PyHSCam_boxFilterRow<Mono16Format>(const char * srcRow0, const char * srcRow1, char * dstRow,
+                                        unsigned long outWidth)
+{
+    // SSE2: 8 source pixels of each row -> 4 output pixels, summed in 32-bit lanes. There is
+    // no unsigned 32 -> 16 bit pack in SSE2, so results are biased into signed range first.
+    const __m128i lowWords = _mm_set1_epi32(0x0000FFFF);
+    const __m128i rounding = _mm_set1_epi32(2);
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i unbias = _mm_set1_epi16((short)0x8000);
+    const uint16_t * src0 = (const uint16_t *)srcRow0;
+    const uint16_t * src1 = (const uint16_t *)srcRow1;
+    uint16_t * dst = (uint16_t *)dstRow;
+    unsigned long col = 0;
+    for (; col + 4 <= outWidth; col += 4)
+    {
+        __m128i row0 = _mm_loadu_si128((const __m128i *)(src0 + col * 2));
+        __m128i row1 = _mm_loadu_si128((const __m128i *)(src1 + col * 2));
+        __m128i even = _mm_add_epi32(_mm_and_si128(row0, lowWords), _mm_and_si128(row1, lowWords));
+        __m128i odd = _mm_add_epi32(_mm_srli_epi32(row0, 16), _mm_srli_epi32(row1, 16));
+        __m128i avg = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(even, odd), rounding), 2);
+        avg = _mm_sub_epi32(avg, bias);
+        _mm_storel_epi64((__m128i *)(dst + col), _mm_xor_si128(_mm_packs_epi32(avg, avg), unbias));
+    }
+    if (col < outWidth)
+    {
+        PyHSCam_boxFilterRowScalar<uint16_t, 1>((const char *)(src0 + col * 2), (const char *)(src1 + col * 2),
+                                                (char *)(dst + col), outWidth - col);
+    }
+}
+
+struct BoxFilterRowSelector
+{
+    typedef BoxFilterRowFn Result;
+    template <class Format>
+    Result run()
+    {
+        return &PyHSCam_boxFilterRow<Format>;
+    }
+};
+
+void PyHSCam_boxFilter(const char * src, unsigned long srcWidth, unsigned long srcHeight,
+                        const PixelFormat & format, BoxFilterRowFn boxFilterRow, char * dst)
+{
+    // Downsample src by two in each direction into dst
+    unsigned long outWidth = srcWidth / 2;
+    unsigned long outHeight = srcHeight / 2;
+    size_t srcStride = (size_t)srcWidth * format.bytesPerPixel;
+    size_t dstStride = (size_t)outWidth * format.bytesPerPixel;
+    unsigned long row;
+    for (row = 0; row < outHeight; row++)
+    {
+        const char * srcRow0 = src + row * 2 * srcStride;
+        boxFilterRow(srcRow0, srcRow0 + srcStride, dst + row * dstStride, outWidth);
+    }
+}
+
+template <typename Sample>
+uint64_t PyHSCam_sumAbsDiff(const Sample * a, const Sample * b, size_t count)
+{
+    uint64_t sum = 0;
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        sum += (a[i] > b[i]) ? (a[i] - b[i]) : (b[i] - a[i]);
+    }
+    return sum;
+}
+
+template <>
+uint64_t PyHSCam_sumAbsDiff<uint8_t>(const uint8_t * a, const uint8_t * b, size_t count)
+{
+    // SSE2 psadbw: two 64-bit partial sums per 16 samples
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *)(a + i)),
+                                                _mm_loadu_si128((const __m128i *)(b + i))));
+    }
+    uint64_t partial[2];
+    _mm_storeu_si128((__m128i *)partial, acc);
+    uint64_t sum = partial[0] + partial[1];
+    for (; i < count; i++)
+    {
+        sum += (a[i] > b[i]) ? (a[i] - b[i]) : (b[i] - a[i]);
+    }
+    return sum;
+}
+
+float PyHSCam_changeScore(const char * thumb, const char * prevThumb, size_t sampleCount,
+                            const PixelFormat & format)
+{
+    // Mean absolute difference of two thumbnails, scaled to [0, 1]
+    if (sampleCount == 0)
+    {
+        return 0.0f;
+    }
+    uint64_t sum;
+    if (format.bitDepth == 8)
+    {
+        sum = PyHSCam_sumAbsDiff<uint8_t>((const uint8_t *)thumb, (const uint8_t *)prevThumb, sampleCount);
+    }
+    else
+    {
+        sum = PyHSCam_sumAbsDiff<uint16_t>((const uint16_t *)thumb, (const uint16_t *)prevThumb, sampleCount);
+    }
+    double maxValue = (double)((1UL << format.bitDepth) - 1);
+    return (float)((double)sum / ((double)sampleCount * maxValue));
+}
+
+
+// Resumable downloads
+// downloadToFile() writes frames to a raw file (frame k of the job at offset k * frameSize)
+// and records completed frame ranges in a sidecar checkpoint file, path + ".ckpt":
+//   PyHSCamDownload startFrame frameCount width height channels bitDepth overview
+//                   recStart recEnd recTrigger
+//   firstFrame lastFrame      (one line per completed, flushed range - job relative, inclusive)
+// rec* are the device's m_nStart, m_nEnd and m_nTrigger, which identify the recording so
+// that frames of a later shot with the same settings are never joined to an earlier one.
+// Calling downloadToFile() again with the same arguments (after a reconnect or a process
+// restart) only fetches the frames which are missing. Jobs only read from device memory.
+#define DOWNLOAD_CHECKPOINT_INTERVAL 64     // Frames written between checkpoint updates
+#define DOWNLOAD_MAX_RETRIES 5
+#define DOWNLOAD_RETRY_BASE_DELAY 100       // ms, doubled after every failed attempt
+
+#ifdef PYHSCAM_FAULT_INJECTION
+// Build with define=PYHSCAM_FAULT_INJECTION to make memory reads fail on demand, which
+// lets the retry and resume logic be exercised without a flaky link. Every Nth read
+// failing exercises the retries; every read failing after the first K (a dropped link)
+// exhausts them partway through a download so that resuming can be tested.
+unsigned long faultInjectionInterval = 0;
+unsigned long faultInjectionFailAfter = 0;
+unsigned long faultInjectionErrorCode = 0;
+unsigned long faultInjectionCounter = 0;
+
+void PyHSCam_setFaultInjection(unsigned long interval, unsigned long errorCode, unsigned long failAfter)
+{
+    faultInjectionInterval = interval;
+    faultInjectionFailAfter = failAfter;
+    faultInjectionErrorCode = errorCode;
+    faultInjectionCounter = 0;
+}
+#endif
+
+unsigned long PyHSCam_readMemImage(uint64_t interfaceId, const PixelFormat & format, long frameNo,
+                                    char * imageBuf, unsigned long * errorCode)
+{
+    SdkLock sdkLock(sdkMutex);
+
+#ifdef PYHSCAM_FAULT_INJECTION
+    faultInjectionCounter++;
+    if ((faultInjectionInterval != 0 && (faultInjectionCounter % faultInjectionInterval) == 0) ||
+        (faultInjectionFailAfter != 0 && faultInjectionCounter > faultInjectionFailAfter))
+    {
+        *errorCode = faultInjectionErrorCode;
+        return PDC_FAILED;
+    }
+#endif
+    return PDC_GetMemImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                frameNo,
+                                format.bitDepth,
+                                imageBuf,       // Output
+                                errorCode);     // Output
+}
+
+bool PyHSCam_isMemReadRetryable(uint64_t interfaceId)
+{
+    // A failed read can only succeed later while the device still holds the recording.
+    // Once it has left playback (switched to live, re-armed, ...) retrying is pointless.
+    // If even the status can't be read the link is probably down, which may be transient.
+    try
+    {
+        return PyHSCam_getStatus(interfaceId) == PDC_STATUS_PLAYBACK;
+    }
+    catch (CamRuntimeError &)
+    {
+        return true;
+    }
+}
+
+unsigned long PyHSCam_readMemImageWithRetry(uint64_t interfaceId, const PixelFormat & format, long frameNo,
+                                            char * imageBuf, unsigned long * errorCode)
+{
+    // Retry transient read failures with exponential backoff.
+    unsigned long retVal;
+    unsigned long delay = DOWNLOAD_RETRY_BASE_DELAY;
+    int attempt;
+    for (attempt = 0; ; attempt++)
+    {
+        retVal = PyHSCam_readMemImage(interfaceId, format, frameNo, imageBuf, errorCode);
+        if (retVal != PDC_FAILED || attempt == DOWNLOAD_MAX_RETRIES ||
+            !PyHSCam_isMemReadRetryable(interfaceId))
+        {
+            return retVal;
+        }
+        Sleep(delay);
+        delay *= 2;
+    }
+}
+
+void PyHSCam_closeDownloadFiles(std::vector<FILE *> & files)
+{
+    size_t i;
+    for (i = 0; i < files.size(); i++)
+    {
+        if (files[i] != NULL)
+        {
+            fclose(files[i]);
+        }
+    }
+    files.clear();
+}
+
+bool PyHSCam_openDownloadFiles(const std::vector<std::string> & paths, const char * mode,
+                                std::vector<FILE *> & files)
+{
+    // Open every file of a download job, or none of them
+    size_t i;
+    files.assign(paths.size(), NULL);
+    for (i = 0; i < paths.size(); i++)
+    {
+        files[i] = fopen(paths[i].c_str(), mode);
+        if (files[i] == NULL)
+        {
+            PyHSCam_closeDownloadFiles(files);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PyHSCam_flushDownloadFiles(std::vector<FILE *> & files)
+{
+    size_t i;
+    for (i = 0; i < files.size(); i++)
+    {
+        if (fflush(files[i]) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PyHSCam_writeDownloadFrame(FILE * file, unsigned long frameIdx, const char * data, size_t size)
+{
+    return _fseeki64(file, (int64_t)frameIdx * size, SEEK_SET) == 0 &&
+            fwrite(data, 1, size, file) == size;
+}
+
+unsigned long PyHSCam_downloadToFile(uint64_t interfaceId, std::string path,
+                                        unsigned long startFrame, unsigned long frameCount,
+                                        bool overview)
+{
+    // Returns the number of frames downloaded by this call. Nothing here touches python
+    // objects, so other python threads keep running during the offload and its retries.
+    GilRelease gilRelease;
+
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+
+    PDC_FRAME_INFO frameInfo;
+    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+    if (!PyHSCam_isFrameRangeRecorded(frameInfo, startFrame, frameCount))
+    {
+        throw CamRuntimeError("Failed to download images - frame range is out of range for recorded images.");
+    }
+
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    uint32_t imageBufSize = format.frameSize(resolution.width, resolution.height);
+
+    // Job files: the frame data, then (with overview) one file per thumbnail level and the scores
+    std::vector<std::string> filePaths(1, path);
+    std::vector<size_t> levelSizes;
+    unsigned long level;
+    if (overview)
+    {
+        for (level = 1; level <= OVERVIEW_LEVELS; level++)
+        {
+            std::ostringstream levelPath;
+            levelPath << path << ".thumb" << (1 << level);
+            filePaths.push_back(levelPath.str());
+            levelSizes.push_back(format.frameSize(resolution.width >> level, resolution.height >> level));
+        }
+        filePaths.push_back(path + ".scores");
+    }
+
+    // Load the checkpoint of a previous attempt, if any
+    std::string ckptPath = path + ".ckpt";
+    std::vector<bool> frameDone(frameCount, false);
+    bool resuming = false;
+    std::vector<FILE *> files;
+    FILE * ckptFile = fopen(ckptPath.c_str(), "r");
+    if (ckptFile != NULL)
+    {
+        unsigned long ckptStart;
+        unsigned long ckptCount;
+        unsigned long ckptWidth;
+        unsigned long ckptHeight;
+        unsigned long ckptChannels;
+        unsigned long ckptBitDepth;
+        unsigned long ckptOverview;
+        long ckptRecStart;
+        long ckptRecEnd;
+        long ckptRecTrigger;
+        char headerLine[256];
+        int fieldCount = 0;
+        if (fgets(headerLine, sizeof(headerLine), ckptFile) != NULL)
+        {
+            fieldCount = sscanf(headerLine, "PyHSCamDownload %lu %lu %lu %lu %lu %lu %lu %ld %ld %ld",
+                                &ckptStart, &ckptCount, &ckptWidth, &ckptHeight,
+                                &ckptChannels, &ckptBitDepth, &ckptOverview,
+                                &ckptRecStart, &ckptRecEnd, &ckptRecTrigger);
+        }
+        if (fieldCount != 10 ||
+            ckptStart != startFrame || ckptCount != frameCount ||
+            ckptWidth != resolution.width || ckptHeight != resolution.height ||
+            ckptChannels != format.channels || ckptBitDepth != format.bitDepth ||
+            (ckptOverview != 0) != overview)
+        {
+            fclose(ckptFile);
+            throw CamRuntimeError("Checkpoint file belongs to a different download. "
+                                    "Use another path or delete the old files.");
+        }
+        if (ckptRecStart != frameInfo.m_nStart || ckptRecEnd != frameInfo.m_nEnd ||
+            ckptRecTrigger != frameInfo.m_nTrigger)
+        {
+            fclose(ckptFile);
+            throw CamRuntimeError("Checkpoint file belongs to a different recording - the device has "
+                                    "recorded again since. Use another path or delete the old files.");
+        }
+        unsigned long rangeFirst;
+        unsigned long rangeLast;
+        while (fscanf(ckptFile, "%lu %lu", &rangeFirst, &rangeLast) == 2)
+        {
+            unsigned long frameIdx;
+            for (frameIdx = rangeFirst; frameIdx <= rangeLast && frameIdx < frameCount; frameIdx++)
+            {
+                frameDone[frameIdx] = true;
+            }
+        }
+        fclose(ckptFile);
+
+        // Without the data files the checkpoint is meaningless - start over
+        resuming = PyHSCam_openDownloadFiles(filePaths, "r+b", files);
+    }
+    if (!resuming)
+    {
+        frameDone.assign(frameCount, false);
+        if (!PyHSCam_openDownloadFiles(filePaths, "wb", files))
+        {
+            throw CamRuntimeError("Failed to create download file.");
+        }
+    }
+
+    ckptFile = fopen(ckptPath.c_str(), resuming ? "a" : "w");
+    if (ckptFile == NULL)
+    {
+        PyHSCam_closeDownloadFiles(files);
+        throw CamRuntimeError("Failed to open checkpoint file.");
+    }
+    if (!resuming)
+    {
+        fprintf(ckptFile, "PyHSCamDownload %lu %lu %lu %lu %lu %lu %lu %ld %ld %ld\n",
+                startFrame, frameCount, resolution.width, resolution.height, format.channels, format.bitDepth,
+                overview ? 1UL : 0UL, frameInfo.m_nStart, frameInfo.m_nEnd, frameInfo.m_nTrigger);
+        fflush(ckptFile);
+    }
+
+    std::vector<char> imageBuf(imageBufSize);
+    std::vector<std::vector<char> > levelBufs(levelSizes.size());
+    std::vector<char> prevThumb;
+    BoxFilterRowFn boxFilterRow = NULL;
+    if (overview)
+    {
+        for (level = 0; level < OVERVIEW_LEVELS; level++)
+        {
+            levelBufs[level].resize(levelSizes[level]);
+        }
+        prevThumb.resize(levelSizes[OVERVIEW_LEVELS - 1]);
+        BoxFilterRowSelector selector;
+        boxFilterRow = PyHSCam_dispatchPixelFormat(format.id, selector);
+    }
+    FILE * dataFile = files[0];
+    // Samples in the smallest thumbnail, which is what change scores compare
+    size_t thumbSamples = format.sampleCount(resolution.width >> OVERVIEW_LEVELS,
+                                                resolution.height >> OVERVIEW_LEVELS);
+    // Index of the frame whose smallest thumbnail is in prevThumb, or frameCount for none
+    unsigned long prevThumbIdx = frameCount;
+
+    unsigned long downloaded = 0;
+    // Frames written since the last checkpoint form the range [batchFirst, batchFirst + batchLen)
+    unsigned long batchFirst = 0;
+    unsigned long batchLen = 0;
+    bool ioFailed = false;
+    unsigned long retVal = PDC_SUCCEEDED;
+    unsigned long errorCode = 0;
+
+    unsigned long frameIdx;
+    for (frameIdx = 0; frameIdx <= frameCount; frameIdx++)
+    {
+        bool needFrame = (frameIdx < frameCount) && !frameDone[frameIdx];
+        // Close the batch when it stops being contiguous, fills up, or the job ends
+        if (batchLen > 0 &&
+            (!needFrame || batchLen == DOWNLOAD_CHECKPOINT_INTERVAL))
+        {
+            // Frame data must reach the files before the checkpoint claims it
+            if (!PyHSCam_flushDownloadFiles(files))
+            {
+                ioFailed = true;
+                break;
+            }
+            fprintf(ckptFile, "%lu %lu\n", batchFirst, batchFirst + batchLen - 1);
+            fflush(ckptFile);
+            batchLen = 0;
+        }
+        if (!needFrame)
+        {
+            continue;
+        }
+
+        retVal = PyHSCam_readMemImageWithRetry(interfaceId,
+                                                format,
+                                                frameInfo.m_nStart + startFrame + frameIdx,
+                                                &imageBuf[0],
+                                                &errorCode);
+        if (retVal == PDC_FAILED)
+        {
+            // Keep what has already been written; the next attempt resumes from here.
+            if (batchLen > 0 && PyHSCam_flushDownloadFiles(files))
+            {
+                fprintf(ckptFile, "%lu %lu\n", batchFirst, batchFirst + batchLen - 1);
+            }
+            break;
+        }
+
+        if (!PyHSCam_writeDownloadFrame(dataFile, frameIdx, &imageBuf[0], imageBufSize))
+        {
+            ioFailed = true;
+            break;
+        }
+
+        if (overview)
+        {
+            // Each level is filtered from the one above it
+            const char * src = &imageBuf[0];
+            for (level = 0; level < OVERVIEW_LEVELS; level++)
+            {
+                PyHSCam_boxFilter(src,
+                                    resolution.width >> level,
+                                    resolution.height >> level,
+                                    format,
+                                    boxFilterRow,
+                                    levelBufs[level].data());
+                if (!PyHSCam_writeDownloadFrame(files[1 + level], frameIdx,
+                                                levelBufs[level].data(), levelSizes[level]))
+                {
+                    ioFailed = true;
+                    break;
+                }
+                src = levelBufs[level].data();
+            }
+            if (ioFailed)
+            {
+                break;
+            }
+
+            // A previous run may have stopped just before this frame; its thumbnail is on disk
+            const std::vector<char> & thumb = levelBufs[OVERVIEW_LEVELS - 1];
+            FILE * thumbFile = files[OVERVIEW_LEVELS];
+            if (frameIdx > 0 && prevThumbIdx != frameIdx - 1)
+            {
+                if (_fseeki64(thumbFile, (int64_t)(frameIdx - 1) * thumb.size(), SEEK_SET) != 0 ||
+                    fread(prevThumb.data(), 1, thumb.size(), thumbFile) != thumb.size())
+                {
+                    ioFailed = true;
+                    break;
+                }
+            }
+            float score = 0.0f;
+            if (frameIdx > 0)
+            {
+                score = PyHSCam_changeScore(thumb.data(), prevThumb.data(), thumbSamples, format);
+            }
+            if (!PyHSCam_writeDownloadFrame(files[1 + OVERVIEW_LEVELS], frameIdx,
+                                            (const char *)&score, sizeof(score)))
+            {
+                ioFailed = true;
+                break;
+            }
+            prevThumb = thumb;
+            prevThumbIdx = frameIdx;
+        }
+
+        if (batchLen == 0)
+        {
+            batchFirst = frameIdx;
+        }
+        batchLen++;
+        downloaded++;
+    }
+
+    fclose(ckptFile);
+    PyHSCam_closeDownloadFiles(files);
+
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Download interrupted - failed to retrieve image from memory! "
+                                "Call downloadToFile() again to resume.", errorCode);
+    }
+    if (ioFailed)
+    {
+        throw CamRuntimeError("Download interrupted - failed to write to download file.");
+    }
+    return downloaded;
+}
+
+
+// Triggered recording
+// armTrigger() records around an event instead of for a fixed time: in end, center and
+// manual modes the device records endlessly into its memory ring once armed and stops a
+// number of frames after the trigger; in start mode the trigger begins the recording.
+// The trigger is an external signal or triggerIn(). getTriggerWindow() then downloads only
+// the frames around m_nTrigger rather than the whole recording.
+#define TRIGGER_POLL_INTERVAL 1     // ms between status checks while waiting for a trigger
+
+unsigned long PyHSCam_parseTriggerMode(const std::string & mode)
+{
+    if (mode == "start")
+    {
+        return PDC_TRIGGER_START;
+    }
+    else if (mode == "center")
+    {
+        return PDC_TRIGGER_CENTER;
+    }
+    else if (mode == "end")
+    {
+        return PDC_TRIGGER_END;
+    }
+    else if (mode == "manual")
+    {
+        return PDC_TRIGGER_MANUAL;
+    }
+    throw CamRuntimeError("Unknown trigger mode. Valid modes are start, center, end and manual.");
+}
+
+void PyHSCam_armTrigger(uint64_t interfaceId, std::string mode, unsigned long framesBefore,
+                        unsigned long framesAfter)
+{
+    unsigned long triggerMode = PyHSCam_parseTriggerMode(mode);
+    unsigned long afterFrames = 0;
+
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+
+    if (triggerMode == PDC_TRIGGER_MANUAL)
+    {
+        // The device only takes the count after the trigger; everything else in memory
+        // is before it. So exactly one of the counts can be chosen.
+        unsigned long maxFrames = PyHSCam_getMaxFrames(interfaceId);
+        if ((framesBefore == 0) == (framesAfter == 0))
+        {
+            throw CamRuntimeError("Manual trigger mode requires either framesBefore or framesAfter, not both.");
+        }
+        if (framesBefore > maxFrames || framesAfter > maxFrames)
+        {
+            std::ostringstream msg;
+            msg << "Only " << maxFrames << " frames fit in device memory at the current resolution.";
+            throw CamRuntimeError(msg.str());
+        }
+        afterFrames = (framesAfter != 0) ? framesAfter : maxFrames - framesBefore;
+    }
+    else if (framesBefore != 0 || framesAfter != 0)
+    {
+        throw CamRuntimeError("Frame counts can only be set in manual trigger mode. "
+                                "Use getTriggerWindow() to limit the frames downloaded.");
+    }
+
+    PyHSCam_armRecording(interfaceId, triggerMode, afterFrames);
+}
+
+void PyHSCam_triggerIn(uint64_t interfaceId)
+{
+    // Software trigger, equivalent to the external trigger input
+    SdkLock sdkLock(sdkMutex);
+
+    unsigned long retVal;
+    unsigned long errorCode;
+    retVal = PDC_TriggerIn(IFACE_ID_GET_DEV_NUM(interfaceId),
+                            &errorCode);
+    if (retVal == PDC_FAILED)
+    {
+        throw CamRuntimeError("Failed to trigger device!", errorCode);
+    }
+}
+
+bool PyHSCam_waitForTrigger(uint64_t interfaceId, uint64_t timeout)
+{
+    // Wait up to timeout ms for an armed device to be triggered and finish recording.
+    // Returns false on timeout, in which case the device is left armed.
+    GilRelease gilRelease;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    unsigned long deviceStatus;
+    for (;;)
+    {
+        deviceStatus = PyHSCam_getStatus(interfaceId);
+        if ((deviceStatus != PDC_STATUS_RECREADY) &&
+            (deviceStatus != PDC_STATUS_ENDLESS) &&
+            (deviceStatus != PDC_STATUS_REC))
+        {
+            // Recording has finished.
+            return true;
+        }
+        if (PyHSCam_elapsedMs(startTime) >= timeout)
+        {
+            return false;
+        }
+        Sleep(TRIGGER_POLL_INTERVAL);
+    }
+}
+
+long PyHSCam_getTriggerFrame(uint64_t interfaceId)
+{
+    // Memory frame number (as used by getImageFromMemory() etc.) of the trigger frame
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+
+    PDC_FRAME_INFO frameInfo;
+    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+    return frameInfo.m_nTrigger - frameInfo.m_nStart;
+}
+
+boost::python::tuple PyHSCam_getTriggerWindow(uint64_t interfaceId, unsigned long framesBefore,
+                                                unsigned long framesAfter)
+{
+    // Download the recorded frames from framesBefore before the trigger frame to framesAfter
+    // after it, clipped to what was recorded. Returns (firstOffset, frames) where firstOffset
+    // is the position of frames[0] relative to the trigger frame (0 or negative).
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+
+    PDC_FRAME_INFO frameInfo;
+    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+    if (frameInfo.m_nRecordedFrames <= 0)
+    {
+        throw CamRuntimeError("Failed to retrieve trigger window - device memory is empty.");
+    }
+
+    // Computed in 64 bits so large counts can't wrap around the frame numbers
+    long firstFrame = (long)std::max<int64_t>((int64_t)frameInfo.m_nStart,
+                                                (int64_t)frameInfo.m_nTrigger - (int64_t)framesBefore);
+    long lastFrame = (long)std::min<int64_t>((int64_t)frameInfo.m_nEnd,
+                                                (int64_t)frameInfo.m_nTrigger + (int64_t)framesAfter);
+
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    uint32_t imageBufSize = format.frameSize(resolution.width, resolution.height);
+    std::vector<char> imageBuf(imageBufSize);
+
+    boost::python::list frames;
+    unsigned long retVal;
+    unsigned long errorCode;
+    long frameNo;
+    for (frameNo = firstFrame; frameNo <= lastFrame; frameNo++)
+    {
+        retVal = PyHSCam_readMemImageWithRetry(interfaceId, format, frameNo, &imageBuf[0], &errorCode);
+        if (retVal == PDC_FAILED)
+        {
+            throw CamRuntimeError("Failed to retrieve image from memory!", errorCode);
+        }
+        frames.append(boost::python::object(boost::python::handle<>(
+            PyHSCam_imageToBytes(interfaceId, &imageBuf[0], resolution, imageBufSize))));
+    }
+
+    return boost::python::make_tuple(firstFrame - frameInfo.m_nTrigger, frames);
+}
+
+
+// Shared-memory frame ring
+// Frames from the live and memory paths can be published into a named shared-memory
+// ring so that any number of local processes can read them without copying.
+// Layout: [FrameRingHeader][slot 0][slot 1]...[slot slotCount-1]
+// Each slot has a sequence number which is 0 while the slot is being written and
+// the (nonzero) sequence number of the frame it holds otherwise. A reader that finds
+// a different sequence number than it asked for knows the frame has been overwritten.
+#define FRAME_RING_MAGIC 0x474e5248  // "HRNG"
+#define FRAME_RING_MAX_SLOTS 256
+
+struct FrameRingSlotInfo
+{
+    volatile LONG seq;
+    LONG frameNumber;       // Frame index in device memory, or -1 for live images
+};
+
+struct FrameRingHeader
+{
+    uint32_t magic;
+    uint32_t slotCount;
+    uint32_t slotSize;      // Bytes per slot
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;      // 1 = mono, 3 = BGR interleaved
+    uint32_t bitDepth;      // Bits per sample, 8 or 16
+    volatile LONG writeSeq; // Sequence number of the most recently completed frame
+    FrameRingSlotInfo slots[FRAME_RING_MAX_SLOTS];
+};
+
+struct FrameRing
+{
+    HANDLE mapping;
+    FrameRingHeader * header;
+    char * data;
+    LONG nextSeq;
+};
+
+// Rings currently published by this process, keyed by interfaceId
+std::map<uint64_t, FrameRing> frameRings;
+
+
+FrameRing & PyHSCam_getFrameRing(uint64_t interfaceId)
+{
+    std::map<uint64_t, FrameRing>::iterator it = frameRings.find(interfaceId);
+    if (it == frameRings.end())
+    {
+        throw CamRuntimeError("No frame ring has been created for this interfaceId.");
+    }
+    return it->second;
+}
+
+void PyHSCam_createFrameRing(uint64_t interfaceId, std::string name, unsigned long slotCount)
+{
+    if (frameRings.find(interfaceId) != frameRings.end())
+    {
+        throw CamRuntimeError("A frame ring already exists for this interfaceId.");
+    }
+    if (slotCount == 0 || slotCount > FRAME_RING_MAX_SLOTS)
+    {
+        throw CamRuntimeError("Frame ring slot count is out of range.");
+    }
+
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+
+    uint32_t slotSize = format.frameSize(resolution.width, resolution.height);
+    uint64_t mappingSize = sizeof(FrameRingHeader) + (uint64_t)slotSize * slotCount;
+
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE,  // Backed by the page file
+                                        NULL,
+                                        PAGE_READWRITE,
+                                        (DWORD)(mappingSize >> 32),
+                                        (DWORD)(mappingSize & 0xffffffff),
+                                        name.c_str());
+    if (mapping == NULL)
+    {
+        throw CamRuntimeError("Failed to create shared memory for frame ring!", GetLastError());
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(mapping);
+        throw CamRuntimeError("A shared memory object with this name already exists.");
+    }
+
+    void * view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (view == NULL)
+    {
+        unsigned long errorCode = GetLastError();
+        CloseHandle(mapping);
+        throw CamRuntimeError("Failed to map frame ring!", errorCode);
+    }
+
+    FrameRing ring;
+    ring.mapping = mapping;
+    ring.header = (FrameRingHeader *)view;
+    ring.data = (char *)view + sizeof(FrameRingHeader);
+    ring.nextSeq = 1;
+
+    memset(ring.header, 0, sizeof(FrameRingHeader));
+    ring.header->slotCount = slotCount;
+    ring.header->slotSize = slotSize;
+    ring.header->width = resolution.width;
+    ring.header->height = resolution.height;
+    ring.header->channels = format.channels;
+    ring.header->bitDepth = format.bitDepth;
+    // Publish the magic number last so readers never see a half-initialized header
+    MemoryBarrier();
+    ring.header->magic = FRAME_RING_MAGIC;
+
+    frameRings[interfaceId] = ring;
+}
+
+void PyHSCam_destroyFrameRing(uint64_t interfaceId)
+{
+    // Readers which are still attached keep the shared memory alive until they detach.
+    FrameRing & ring = PyHSCam_getFrameRing(interfaceId);
+    UnmapViewOfFile(ring.header);
+    CloseHandle(ring.mapping);
+    frameRings.erase(interfaceId);
+}
+
+void PyHSCam_moveFrameRing(uint64_t oldInterfaceId, uint64_t newInterfaceId)
+{
+    // Keep publishing into the same ring after reconnect() changes the interfaceId.
+    std::map<uint64_t, FrameRing>::iterator it = frameRings.find(oldInterfaceId);
+    if (it == frameRings.end() || oldInterfaceId == newInterfaceId)
+    {
+        return;
+    }
+    frameRings[newInterfaceId] = it->second;
+    frameRings.erase(it);
+}
+
+void PyHSCam_assertRingGeometry(uint64_t interfaceId, FrameRing & ring)
+{
+    // Slots are sized at creation time, so the resolution must not change afterwards.
+    Resolution resolution = PyHSCam_getResolution(interfaceId);
+    if (resolution.width != ring.header->width || resolution.height != ring.header->height)
+    {
+        throw CamRuntimeError("Resolution has changed since the frame ring was created.");
+    }
+    PixelFormat format = PyHSCam_getPixelFormat(interfaceId);
+    if (format.channels != ring.header->channels || format.bitDepth != ring.header->bitDepth)
+    {
+        throw CamRuntimeError("Pixel format has changed since the frame ring was created.");
+    }
+}
+
+char * PyHSCam_beginRingWrite(FrameRing & ring, LONG & seq)
+{
+    // Claim the next slot and invalidate it so that readers don't use it mid-write.
+    seq = ring.nextSeq;
+    // Sequence numbers must stay positive - 0 marks a slot that is being written
+    ring.nextSeq = (seq == LONG_MAX) ? 1 : seq + 1;
+    unsigned long slotIdx = seq % ring.header->slotCount;
+    InterlockedExchange(&ring.header->slots[slotIdx].seq, 0);
+    return ring.data + (uint64_t)slotIdx * ring.header->slotSize;
+}
+
+void PyHSCam_endRingWrite(FrameRing & ring, LONG seq, LONG frameNumber)
+{
+    unsigned long slotIdx = seq % ring.header->slotCount;
+    ring.header->slots[slotIdx].frameNumber = frameNumber;
+    InterlockedExchange(&ring.header->slots[slotIdx].seq, seq);
+    InterlockedExchange(&ring.header->writeSeq, seq);
+}
+
+long PyHSCam_publishLiveImage(uint64_t interfaceId)
+{
+    // Same as captureLiveImage() but the frame is written directly into the ring.
+    SdkLock sdkLock(sdkMutex);
+
+    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+
+    FrameRing & ring = PyHSCam_getFrameRing(interfaceId);
+    PyHSCam_assertRingGeometry(interfaceId, ring);
+
+    unsigned long errorCode;
+    unsigned long retVal;
+    LONG seq;
+    char * slotBuf = PyHSCam_beginRingWrite(ring, seq);
+
+    retVal = PDC_GetLiveImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                    ring.header->bitDepth,
+                                    slotBuf,
+                                    &errorCode);
+    if (retVal == PDC_FAILED)
+    {
+        // The slot stays invalidated; readers will skip it
+        throw CamRuntimeError("Failed to retrive live image!", errorCode);
+    }
+
+    PyHSCam_endRingWrite(ring, seq, -1);
+    return seq;
+}
+
+long PyHSCam_publishMemoryImages(uint64_t interfaceId, unsigned long startFrame, unsigned long frameCount)
+{
+    // Publish frames [startFrame, startFrame + frameCount) from device memory into the ring.
+    // Returns the sequence number of the last published frame. sdkMutex is taken per frame
+    // so that frame server threads aren't blocked for the whole range.
+    FrameRing & ring = PyHSCam_getFrameRing(interfaceId);
+
+    PDC_FRAME_INFO frameInfo;
+    {
+        SdkLock sdkLock(sdkMutex);
+        PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+        PyHSCam_assertRingGeometry(interfaceId, ring);
+        frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+    }
+
+    if (!PyHSCam_isFrameRangeRecorded(frameInfo, startFrame, frameCount))
+    {
+        throw CamRuntimeError("Failed to publish images - frame range is out of range for recorded images.");
+    }
+
+    unsigned long errorCode;
+    unsigned long retVal;
+    LONG seq = 0;
+    unsigned long frameN;
+    for (frameN = startFrame; frameN < startFrame + frameCount; frameN++)
+    {
+        char * slotBuf = PyHSCam_beginRingWrite(ring, seq);
+
+        {
+            SdkLock sdkLock(sdkMutex);
+            retVal = PDC_GetMemImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                            IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                            frameInfo.m_nStart + frameN,
+                                            ring.header->bitDepth,
+                                            slotBuf,                // Output
+                                            &errorCode);            // Output
+        }
+        if (retVal == PDC_FAILED)
+        {
+            throw CamRuntimeError("Failed to retrieve image from memory!", errorCode);
+        }
+
+        PyHSCam_endRingWrite(ring, seq, frameN);
+    }
+
+    return seq;
+}
+
+
+// Buffer exporter for one ring slot. It holds a reference to the python FrameRingReader,
+// so memoryviews of the slot (and any slices of them) keep the mapping alive.
+struct FrameRingSlotView
+{
+    PyObject_HEAD
+    PyObject * reader;
+    char * buf;
+    Py_ssize_t len;
+};
+
+int PyHSCam_slotViewGetBuffer(PyObject * self, Py_buffer * view, int flags)
+{
+    FrameRingSlotView * slot = (FrameRingSlotView *)self;
+    return PyBuffer_FillInfo(view, self, slot->buf, slot->len, 1, flags);
+}
+
+void PyHSCam_slotViewDealloc(PyObject * self)
+{
+    Py_XDECREF(((FrameRingSlotView *)self)->reader);
+    PyObject_Del(self);
+}
+
+PyBufferProcs frameRingSlotViewBufferProcs;
+PyTypeObject frameRingSlotViewType = { PyVarObject_HEAD_INIT(NULL, 0) };
+
+void PyHSCam_registerSlotViewType()
+{
+    frameRingSlotViewBufferProcs.bf_getbuffer = PyHSCam_slotViewGetBuffer;
+    frameRingSlotViewType.tp_name = "PyHSCam.FrameRingSlot";
+    frameRingSlotViewType.tp_basicsize = sizeof(FrameRingSlotView);
+    frameRingSlotViewType.tp_dealloc = PyHSCam_slotViewDealloc;
+    frameRingSlotViewType.tp_as_buffer = &frameRingSlotViewBufferProcs;
+    frameRingSlotViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+    if (PyType_Ready(&frameRingSlotViewType) < 0)
+    {
+        boost::python::throw_error_already_set();
+    }
+}
+
+
+class FrameRingReader
+{
+    // Attaches to a ring created by createFrameRing() (in this or any other local process)
+    // and hands out zero-copy views of its slots.
+private:
+    HANDLE mapping;
+    FrameRingHeader * header;
+    const char * data;
+public:
+    FrameRingReader(std::string name)
+    {
+        mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+        if (mapping == NULL)
+        {
+            throw CamRuntimeError("Failed to open frame ring!", GetLastError());
+        }
+        void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL)
+        {
+            unsigned long errorCode = GetLastError();
+            CloseHandle(mapping);
+            throw CamRuntimeError("Failed to map frame ring!", errorCode);
+        }
+        header = (FrameRingHeader *)view;
+        data = (const char *)view + sizeof(FrameRingHeader);
+        if (header->magic != FRAME_RING_MAGIC)
+        {
+            UnmapViewOfFile(view);
+            CloseHandle(mapping);
+            throw CamRuntimeError("Shared memory object is not a frame ring.");
+        }
+    }
+    ~FrameRingReader()
+    {
+        UnmapViewOfFile(header);
+        CloseHandle(mapping);
+    }
+    long latestSequence() const
+    {
+        return header->writeSeq;
+    }
+    bool isValid(long seq) const
+    {
+        // Check after using a view returned by getFrame() to confirm that the
+        // writer didn't overwrite the slot in the meantime.
+        if (seq <= 0)
+        {
+            return false;
+        }
+        return header->slots[seq % header->slotCount].seq == seq;
+    }
+    bool getSlot(long seq, char ** slotBuf, Py_ssize_t * slotSize) const
+    {
+        // Locate frame 'seq' in the mapping. Returns false if it is no longer in the ring.
+        if (!isValid(seq))
+        {
+            return false;
+        }
+        *slotBuf = const_cast<char *>(data) + (uint64_t)(seq % header->slotCount) * header->slotSize;
+        *slotSize = header->slotSize;
+        return true;
+    }
+    long getFrameNumber(long seq) const
+    {
+        return header->slots[seq % header->slotCount].frameNumber;
+    }
+    unsigned long getWidth() const
+    {
+        return header->width;
+    }
+    unsigned long getHeight() const
+    {
+        return header->height;
+    }
+    unsigned long getChannels() const
+    {
+        return header->channels;
+    }
+    unsigned long getBitDepth() const
+    {
+        return header->bitDepth;
+    }
+    unsigned long getSlotCount() const
+    {
+        return header->slotCount;
+    }
+};
+
+PyObject * PyHSCam_getRingFrame(boost::python::object readerObj, long seq)
+{
+    // Returns a read-only memoryview of frame 'seq', or None if it is no longer in the ring.
+    const FrameRingReader & reader = boost::python::extract<const FrameRingReader &>(readerObj);
+    char * slotBuf;
+    Py_ssize_t slotSize;
+    if (!reader.getSlot(seq, &slotBuf, &slotSize))
+    {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+
+    FrameRingSlotView * slot = PyObject_New(FrameRingSlotView, &frameRingSlotViewType);
+    if (slot == NULL)
+    {
+        boost::python::throw_error_already_set();
+    }
+    slot->reader = readerObj.ptr();
+    Py_INCREF(slot->reader);
+    slot->buf = slotBuf;
+    slot->len = slotSize;
+
+    PyObject * view = PyMemoryView_FromObject((PyObject *)slot);
+    Py_DECREF((PyObject *)slot);
+    if (view == NULL)
+    {
+        boost::python::throw_error_already_set();
+    }
+    return view;
+}
+
+
+// Frame streaming server
+// Serves frames from device memory (range requests) or the live feed (subscriptions)
+// over TCP so that remote analysis nodes can pull frames while the camera still holds them.
+// All fields are little-endian uint32 unless noted.
+//
+// Client -> server: FrameServerRequest
+//   FRAME_CMD_INFO           Reply with one header (no payload). frameNumber = recorded frame count
+//                            (0 if the device isn't in playback mode).
+//   FRAME_CMD_GET_RANGE      args[0] = startFrame, args[1] = frameCount. Fails unless the device
+//                            is in playback mode.
+//   FRAME_CMD_SUBSCRIBE_LIVE args[0] = frame count (0 = until the next request or disconnect).
+//                            Fails unless the device is in live mode.
+//   FRAME_CMD_SET_ROI        args[0..3] = x, y, width, height (width = 0 for the full frame),
+//                            args[4] = decimation (1 = every pixel). Applies to all later frames.
+//                            Replied to with a header (no payload) echoing the output geometry.
+// Server -> client: FrameServerFrameHeader followed by payloadSize bytes of image data
+// (16-bit samples are little-endian).
+// A header with a nonzero status carries a PDC error code (or ULONG_MAX) and no payload,
+// and ends the current request.
+// Clients never change the device status; that is left to the local python code, so a
+// remote request can't interrupt a recording or a local download.
+#define FRAME_SERVER_REQUEST_MAGIC 0x51525348  // "HSRQ"
+#define FRAME_SERVER_FRAME_MAGIC 0x52465348    // "HSFR"
+#define FRAME_CMD_INFO 0
+#define FRAME_CMD_GET_RANGE 1
+#define FRAME_CMD_SUBSCRIBE_LIVE 2
+#define FRAME_CMD_SET_ROI 3
+// WSASend accepts any number of buffers but very long lists are slow; send rows in batches
+#define FRAME_SERVER_MAX_WSABUFS 512
+
+struct FrameServerRequest
+{
+    uint32_t magic;
+    uint32_t command;
+    uint32_t args[5];
+};
+
+struct FrameServerFrameHeader
+{
+    uint32_t magic;
+    int32_t frameNumber;    // Device memory frame number, or -1 for live frames
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t bitDepth;      // Bits per sample, 8 or 16
+    uint32_t payloadSize;
+    uint32_t status;
+};
+
+struct FrameServerRoi
+{
+    unsigned long x;
+    unsigned long y;
+    unsigned long width;    // 0 = full frame
+    unsigned long height;
+    unsigned long decimation;
+};
+
+struct FrameServer
+{
+    uint64_t interfaceId;
+    SOCKET listenSocket;
+    std::thread acceptThread;
+    std::vector<std::thread> connectionThreads;
+    std::vector<std::thread::id> finishedConnections;   // Threads which are about to exit
+    std::vector<SOCKET> connectionSockets;
+    std::mutex connectionMutex;
+    std::atomic<bool> running;
+};
+
+// Servers currently running, keyed by interfaceId
+std::map<uint64_t, FrameServer *> frameServers;
+
+
+bool PyHSCam_recvAll(SOCKET sock, char * buf, int len)
+{
+    while (len > 0)
+    {
+        int received = recv(sock, buf, len, 0);
+        if (received <= 0)
+        {
+            return false;
+        }
+        buf += received;
+        len -= received;
+    }
+    return true;
+}
+
+bool PyHSCam_sendBuffers(SOCKET sock, WSABUF * bufs, unsigned long bufCount)
+{
+    // Scatter-gather send of bufs, retrying on partial sends.
+    while (bufCount > 0)
+    {
+        DWORD sent;
+        DWORD batch = (bufCount < FRAME_SERVER_MAX_WSABUFS) ? bufCount : FRAME_SERVER_MAX_WSABUFS;
+        if (WSASend(sock, bufs, batch, &sent, 0, NULL, NULL) == SOCKET_ERROR)
+        {
+            return false;
+        }
+        // Skip fully sent buffers and trim a partially sent one
+        while (bufCount > 0 && sent >= bufs->len)
+        {
+            sent -= bufs->len;
+            bufs++;
+            bufCount--;
+        }
+        if (bufCount > 0)
+        {
+            bufs->buf += sent;
+            bufs->len -= sent;
+        }
+    }
+    return true;
+}
+
+bool PyHSCam_sendStatus(SOCKET sock, int32_t frameNumber, unsigned long width, unsigned long height,
+                        const PixelFormat & format, unsigned long status)
+{
+    FrameServerFrameHeader header;
+    header.magic = FRAME_SERVER_FRAME_MAGIC;
+    header.frameNumber = frameNumber;
+    header.width = width;
+    header.height = height;
+    header.channels = format.channels;
+    header.bitDepth = format.bitDepth;
+    header.payloadSize = 0;
+    header.status = status;
+
+    WSABUF buf;
+    buf.buf = (CHAR *)&header;
+    buf.len = sizeof(header);
+    return PyHSCam_sendBuffers(sock, &buf, 1);
+}
+
+typedef void (*PackDecimatedRowFn)(const char * srcRow, char * dstRow, unsigned long outWidth,
+                                    unsigned long decimation);
+
+template <class Format>
+void PyHSCam_packDecimatedRow(const char * srcRow, char * dstRow, unsigned long outWidth,
+                                unsigned long decimation)
+{
+    // Copy every decimation-th pixel of srcRow into dstRow
+    typedef typename Format::Sample Sample;
+    const Sample * src = (const Sample *)srcRow;
+    Sample * dst = (Sample *)dstRow;
+    unsigned long col;
+    unsigned long ch;
+    for (col = 0; col < outWidth; col++)
+    {
+        for (ch = 0; ch < Format::channels; ch++)
+        {
+            dst[col * Format::channels + ch] = src[col * decimation * Format::channels + ch];
+        }
+    }
+}
+
+struct PackDecimatedRowSelector
+{
+    typedef PackDecimatedRowFn Result;
+    template <class Format>
+    Result run()
+    {
+        return &PyHSCam_packDecimatedRow<Format>;
+    }
+};
+
+bool PyHSCam_isRoiInFrame(const FrameServerRoi & roi, unsigned long width, unsigned long height)
+{
+    // Each field is checked on its own so that values from a client can't wrap the sums.
+    // Decimation may not skip past the whole ROI.
+    unsigned long roiWidth = (roi.width == 0) ? width : roi.width;
+    unsigned long roiHeight = (roi.width == 0) ? height : roi.height;
+    return roi.x < width && roiWidth != 0 && roiWidth <= width - roi.x &&
+            roi.y < height && roiHeight != 0 && roiHeight <= height - roi.y &&
+            roi.decimation != 0 && roi.decimation <= roiWidth && roi.decimation <= roiHeight;
+}
+
+bool PyHSCam_sendFrame(SOCKET sock, int32_t frameNumber, char * frameBuf, unsigned long width,
+                        unsigned long height, const PixelFormat & format, const FrameServerRoi & roi,
+                        std::vector<WSABUF> & bufs, std::vector<char> & packBuf)
+{
+    // Send a frame (or its ROI) straight from frameBuf. Rows of the ROI are passed to
+    // WSASend as separate buffers so that cropping doesn't need a copy. Only column
+    // decimation packs pixels into packBuf first.
+    unsigned long roiX = roi.x;
+    unsigned long roiY = roi.y;
+    unsigned long roiWidth = (roi.width == 0) ? width : roi.width;
+    unsigned long roiHeight = (roi.width == 0) ? height : roi.height;
+    if (!PyHSCam_isRoiInFrame(roi, width, height))
+    {
+        // The resolution changed after the ROI was set
+        throw CamRuntimeError("ROI is outside the current frame.");
+    }
+
+    unsigned long outWidth = (roiWidth + roi.decimation - 1) / roi.decimation;
+    unsigned long outHeight = (roiHeight + roi.decimation - 1) / roi.decimation;
+    unsigned long outRowSize = outWidth * format.bytesPerPixel;
+
+    FrameServerFrameHeader header;
+    header.magic = FRAME_SERVER_FRAME_MAGIC;
+    header.frameNumber = frameNumber;
+    header.width = outWidth;
+    header.height = outHeight;
+    header.channels = format.channels;
+    header.bitDepth = format.bitDepth;
+    header.payloadSize = outRowSize * outHeight;
+    header.status = 0;
+
+    bufs.resize(outHeight + 1);
+    bufs[0].buf = (CHAR *)&header;
+    bufs[0].len = sizeof(header);
+
+    unsigned long rowStride = width * format.bytesPerPixel;
+    char * roiStart = frameBuf + roiY * rowStride + roiX * format.bytesPerPixel;
+
+    if (roiX == 0 && roiWidth == width && roi.decimation == 1)
+    {
+        // Contiguous - the whole payload is a single buffer
+        bufs[1].buf = roiStart;
+        bufs[1].len = header.payloadSize;
+        return PyHSCam_sendBuffers(sock, &bufs[0], 2);
+    }
+
+    PackDecimatedRowFn packDecimatedRow = NULL;
+    if (roi.decimation != 1)
+    {
+        packBuf.resize(header.payloadSize);
+        PackDecimatedRowSelector selector;
+        packDecimatedRow = PyHSCam_dispatchPixelFormat(format.id, selector);
+    }
+
+    unsigned long row;
+    for (row = 0; row < outHeight; row++)
+    {
+        char * srcRow = roiStart + row * roi.decimation * rowStride;
+        if (roi.decimation == 1)
+        {
+            bufs[row + 1].buf = srcRow;
+        }
+        else
+        {
+            char * dstRow = &packBuf[row * outRowSize];
+            packDecimatedRow(srcRow, dstRow, outWidth, roi.decimation);
+            bufs[row + 1].buf = dstRow;
+        }
+        bufs[row + 1].len = outRowSize;
+    }
+
+    return PyHSCam_sendBuffers(sock, &bufs[0], outHeight + 1);
+}
+
+class LiveSubscription
+{
+    // Counts a connection in liveSubscribers for as long as it streams live images.
+    // Constructed with sdkMutex held.
+private:
+    uint64_t interfaceId;
+public:
+    LiveSubscription(uint64_t interfaceId) : interfaceId(interfaceId)
+    {
+        liveSubscribers[interfaceId]++;
+    }
+    ~LiveSubscription()
+    {
+        SdkLock sdkLock(sdkMutex);
+        liveSubscribers[interfaceId]--;
+    }
+};
+
+bool PyHSCam_hasPendingRequest(SOCKET sock)
+{
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(sock, &readSet);
+    timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 0;
+    return select(0, &readSet, NULL, NULL, &timeout) > 0;
+}
+
+void PyHSCam_serveConnection(FrameServer * server, SOCKET sock)
+{
+    // Runs on its own thread for each client. Never touches python objects.
+    // sdkMutex is only held while talking to the device, never while sending,
+    // so a slow client doesn't stall the others (or python).
+    uint64_t interfaceId = server->interfaceId;
+
+    FrameServerRoi roi;
+    roi.x = 0;
+    roi.y = 0;
+    roi.width = 0;
+    roi.height = 0;
+    roi.decimation = 1;
+
+    // Reused for every frame sent on this connection
+    std::vector<char> frameBuf;
+    std::vector<char> packBuf;
+    std::vector<WSABUF> bufs;
+
+    FrameServerRequest request;
+    bool connected = true;
+    bool pending = false;
+    while (connected && server->running)
+    {
+        if (!pending && !PyHSCam_recvAll(sock, (char *)&request, sizeof(request)))
+        {
+            break;
+        }
+        pending = false;
+        if (request.magic != FRAME_SERVER_REQUEST_MAGIC)
+        {
+            break;
+        }
+
+        unsigned long width = 0;
+        unsigned long height = 0;
+        PixelFormat format = PyHSCam_makePixelFormat<Mono8Format>();
+        try
+        {
+            std::unique_lock<std::recursive_mutex> sdkLock(sdkMutex);
+            Resolution resolution = PyHSCam_getResolution(interfaceId);
+            width = resolution.width;
+            height = resolution.height;
+            format = PyHSCam_getPixelFormat(interfaceId);
+            frameBuf.resize(format.frameSize(width, height));
+
+            if (request.command == FRAME_CMD_INFO)
+            {
+                long frameCount = 0;
+                if (PyHSCam_getStatus(interfaceId) == PDC_STATUS_PLAYBACK)
+                {
+                    frameCount = PyHSCam_getMemoryFrameInfo(interfaceId).m_nRecordedFrames;
+                }
+                sdkLock.unlock();
+                connected = PyHSCam_sendStatus(sock, frameCount, width, height, format, 0);
+            }
+            else if (request.command == FRAME_CMD_SET_ROI)
+            {
+                sdkLock.unlock();
+                FrameServerRoi newRoi;
+                newRoi.x = request.args[0];
+                newRoi.y = request.args[1];
+                newRoi.width = request.args[2];
+                newRoi.height = request.args[3];
+                newRoi.decimation = (request.args[4] == 0) ? 1 : request.args[4];
+                unsigned long roiWidth = (newRoi.width == 0) ? width : newRoi.width;
+                unsigned long roiHeight = (newRoi.width == 0) ? height : newRoi.height;
+                if (!PyHSCam_isRoiInFrame(newRoi, width, height))
+                {
+                    throw CamRuntimeError("ROI is outside the current frame.");
+                }
+                roi = newRoi;
+                connected = PyHSCam_sendStatus(sock,
+                                                -1,
+                                                (roiWidth + roi.decimation - 1) / roi.decimation,
+                                                (roiHeight + roi.decimation - 1) / roi.decimation,
+                                                format,
+                                                0);
+            }
+            else if (request.command == FRAME_CMD_GET_RANGE)
+            {
+                if (PyHSCam_getStatus(interfaceId) != PDC_STATUS_PLAYBACK)
+                {
+                    throw CamRuntimeError("Device is not in playback mode.");
+                }
+                PDC_FRAME_INFO frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+                sdkLock.unlock();
+
+                unsigned long startFrame = request.args[0];
+                unsigned long frameCount = request.args[1];
+                if (!PyHSCam_isFrameRangeRecorded(frameInfo, startFrame, frameCount))
+                {
+                    throw CamRuntimeError("Requested frame range is out of range for recorded images.");
+                }
+
+                unsigned long frameN;
+                for (frameN = startFrame; connected && frameN < startFrame + frameCount; frameN++)
+                {
+                    unsigned long retVal;
+                    unsigned long errorCode;
+                    sdkLock.lock();
+                    retVal = PDC_GetMemImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                                    frameInfo.m_nStart + frameN,
+                                                    format.bitDepth,
+                                                    &frameBuf[0],       // Output
+                                                    &errorCode);        // Output
+                    sdkLock.unlock();
+                    if (retVal == PDC_FAILED)
+                    {
+                        throw CamRuntimeError("Failed to retrieve image from memory!", errorCode);
+                    }
+                    connected = PyHSCam_sendFrame(sock, frameN, &frameBuf[0], width, height, format,
+                                                    roi, bufs, packBuf);
+                }
+            }
+            else if (request.command == FRAME_CMD_SUBSCRIBE_LIVE)
+            {
+                if (PyHSCam_getStatus(interfaceId) != PDC_STATUS_LIVE)
+                {
+                    throw CamRuntimeError("Device is not in live mode.");
+                }
+                LiveSubscription subscription(interfaceId);
+                sdkLock.unlock();
+
+                unsigned long frameCount = request.args[0];
+                unsigned long sentCount = 0;
+                while (connected && server->running && (frameCount == 0 || sentCount < frameCount))
+                {
+                    if (PyHSCam_hasPendingRequest(sock))
+                    {
+                        // Any new request ends the subscription. A disconnect shows up
+                        // as a failed read.
+                        pending = PyHSCam_recvAll(sock, (char *)&request, sizeof(request));
+                        connected = pending;
+                        break;
+                    }
+                    unsigned long retVal;
+                    unsigned long errorCode;
+                    sdkLock.lock();
+                    retVal = PDC_GetLiveImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
+                                                    format.bitDepth,
+                                                    &frameBuf[0],
+                                                    &errorCode);
+                    sdkLock.unlock();
+                    if (retVal == PDC_FAILED)
+                    {
+                        throw CamRuntimeError("Failed to retrive live image!", errorCode);
+                    }
+                    connected = PyHSCam_sendFrame(sock, -1, &frameBuf[0], width, height, format,
+                                                    roi, bufs, packBuf);
+                    sentCount++;
+                }
+            }
+            else
+            {
+                throw CamRuntimeError("Unknown frame server command.");
+            }
+        }
+        catch (CamRuntimeError & except)
+        {
+            unsigned long status = except.hasErrorCode() ? except.getErrorCode() : ULONG_MAX;
+            connected = PyHSCam_sendStatus(sock, -1, width, height, format, status);
+        }
+    }
+
+    // Forget the socket before closing it so stopFrameServer() can't shut down a reused handle
+    std::lock_guard<std::mutex> lock(server->connectionMutex);
+    std::vector<SOCKET>::iterator it;
+    for (it = server->connectionSockets.begin(); it != server->connectionSockets.end(); ++it)
+    {
+        if (*it == sock)
+        {
+            server->connectionSockets.erase(it);
+            break;
+        }
+    }
+    closesocket(sock);
+    server->finishedConnections.push_back(std::this_thread::get_id());
+}
+
+void PyHSCam_reapConnectionThreads(FrameServer * server)
+{
+    // Join the threads of connections that have ended so a long running server doesn't
+    // keep one thread handle per client it has ever served. Call with connectionMutex
+    // held; the finished threads don't need it again, so joining them can't deadlock.
+    std::vector<std::thread>::iterator it = server->connectionThreads.begin();
+    while (it != server->connectionThreads.end())
     {
-        throw CamRuntimeError("Failed to retrieve frame info!", errorCode);
+        if (std::find(server->finishedConnections.begin(),
+                        server->finishedConnections.end(),
+                        it->get_id()) != server->finishedConnections.end())
+        {
+            it->join();
+            it = server->connectionThreads.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
-
-    return frameInfo;
+    server->finishedConnections.clear();
 }
 
-
-long PyHSCam_getMemoryFrameCount(uint64_t interfaceId)
+void PyHSCam_acceptConnections(FrameServer * server)
 {
-    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
+    while (server->running)
+    {
+        SOCKET sock = accept(server->listenSocket, NULL, NULL);
+        if (sock == INVALID_SOCKET)
+        {
+            // The listening socket was closed by stopFrameServer()
+            break;
+        }
 
-    PDC_FRAME_INFO frameInfo;
-    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
+        // Frames are sent in large writes; don't delay the small headers
+        BOOL noDelay = TRUE;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
 
-    return frameInfo.m_nRecordedFrames;
+        std::lock_guard<std::mutex> lock(server->connectionMutex);
+        PyHSCam_reapConnectionThreads(server);
+        server->connectionSockets.push_back(sock);
+        server->connectionThreads.push_back(std::thread(PyHSCam_serveConnection, server, sock));
+    }
 }
 
-
-PyObject * PyHSCam_getImageFromMemory(uint64_t interfaceId, unsigned long frameN)
+void PyHSCam_startFrameServer(uint64_t interfaceId, unsigned short port, std::string bindAddress)
 {
-    // The mode must be set to PDC_STATUS_PLAYBACK to read from memory
-    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_PLAYBACK);
-
-    unsigned long retVal;
-    unsigned long errorCode;
-    clock_t startTime = clock();
-
-    PDC_FRAME_INFO frameInfo;
-    frameInfo = PyHSCam_getMemoryFrameInfo(interfaceId);
-
-    if (frameN > frameInfo.m_nRecordedFrames)
+    if (frameServers.find(interfaceId) != frameServers.end())
     {
-        throw CamRuntimeError("Failed to retrieve image - frameN is out of range for recorded images.");
+        throw CamRuntimeError("A frame server is already running for this interfaceId.");
     }
 
-    char * imageBuf;
-    uint32_t imageBufSize;
-    unsigned long imgWidth;
-    unsigned long imgHeight;
-
-    boost::python::tuple imgResolution = PyHSCam_getCurrentResolution(interfaceId);
-    imgWidth = boost::python::extract<unsigned long>(imgResolution[0]);
-    imgHeight = boost::python::extract<unsigned long>(imgResolution[1]);
-
-    if (PyHSCam_isDeviceMonochromatic(interfaceId))
+    WSADATA wsaData;
+    int wsaError = WSAStartup(MAKEWORD(2, 2), &wsaData);
+    if (wsaError != 0)
     {
-        imageBufSize = imgWidth * imgHeight;
+        throw CamRuntimeError("Failed to initialize winsock!", wsaError);
     }
-    else  // *3 size to account for RGB
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1)
     {
-        imageBufSize = imgWidth * imgHeight * 3;
+        WSACleanup();
+        throw CamRuntimeError("Invalid bind address for frame server.");
     }
 
-    imageBuf = (char *)malloc(imageBufSize);
-
-    retVal = PDC_GetMemImageData(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                    frameInfo.m_nTrigger + frameN,
-                                    8,                      // Assume 8-bit color depth
-                                    imageBuf,               // Output
-                                    &errorCode);            // Output
-
-    if (retVal == PDC_FAILED)
+    SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET)
     {
-        free(imageBuf);
-        throw CamRuntimeError("Failed to retrieve image from memory!", errorCode);
+        unsigned long errorCode = WSAGetLastError();
+        WSACleanup();
+        throw CamRuntimeError("Failed to create frame server socket!", errorCode);
+    }
+    if (bind(listenSocket, (sockaddr *)&addr, sizeof(addr)) == SOCKET_ERROR ||
+        listen(listenSocket, SOMAXCONN) == SOCKET_ERROR)
+    {
+        unsigned long errorCode = WSAGetLastError();
+        closesocket(listenSocket);
+        WSACleanup();
+        throw CamRuntimeError("Failed to listen on frame server port!", errorCode);
     }
 
-    PyObject * pyImageBuf = PyBytes_FromStringAndSize(imageBuf, imageBufSize);
-    free(imageBuf);
+    FrameServer * server = new FrameServer();
+    server->interfaceId = interfaceId;
+    server->listenSocket = listenSocket;
+    server->running = true;
+    server->acceptThread = std::thread(PyHSCam_acceptConnections, server);
 
-    return pyImageBuf;
+    frameServers[interfaceId] = server;
 }
 
-boost::python::tuple PyHSCam_getCurrentResolution(uint64_t interfaceId)
+void PyHSCam_stopFrameServer(uint64_t interfaceId)
 {
-    unsigned long width;
-    unsigned long height;
-    unsigned long errorCode;
-    unsigned long retVal;
+    std::map<uint64_t, FrameServer *>::iterator it = frameServers.find(interfaceId);
+    if (it == frameServers.end())
+    {
+        throw CamRuntimeError("No frame server is running for this interfaceId.");
+    }
+    FrameServer * server = it->second;
+    frameServers.erase(it);
 
-    retVal = PDC_GetResolution(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                &width,         // Output
-                                &height,        // Output
-                                &errorCode);    // Output
+    server->running = false;
+    closesocket(server->listenSocket);
+    server->acceptThread.join();
 
-    if (retVal == PDC_FAILED)
+    // Wake up connections blocked in recv/send so their threads can exit
+    size_t i;
     {
-        throw CamRuntimeError("Failed to read current resolution!", errorCode);
+        std::lock_guard<std::mutex> lock(server->connectionMutex);
+        for (i = 0; i < server->connectionSockets.size(); i++)
+        {
+            shutdown(server->connectionSockets[i], SD_BOTH);
+        }
+    }
+    for (i = 0; i < server->connectionThreads.size(); i++)
+    {
+        server->connectionThreads[i].join();
     }
 
-    return boost::python::make_tuple(width, height);
+    delete server;
+    WSACleanup();
 }
 
-void PyHSCam_setResolution(uint64_t interfaceId, unsigned long width, unsigned long height)
+bool PyHSCam_isFrameServerRunning(uint64_t interfaceId)
 {
-    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+    return frameServers.find(interfaceId) != frameServers.end();
+}
 
-    unsigned long retVal;
-    unsigned long errorCode;
 
-    retVal = PDC_SetResolution(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                width,
-                                height,
-                                &errorCode);    // Output
+double PyHSCam_timeRawGetStatus(uint64_t interfaceId, unsigned long iterations)
+{
+    // Time PDC_GetStatus with no python or binding overhead at all. Returns seconds per call.
+    // Used by benchmark.py as the baseline for the fast call path below.
+    SdkLock sdkLock(sdkMutex);
 
-    if (retVal == PDC_FAILED)
+    if (iterations == 0)
     {
-        throw CamRuntimeError("Failed to set resolution!", errorCode);
+        throw CamRuntimeError("iterations must be at least 1!");
     }
-}
 
-boost::python::list PyHSCam_getAllValidResolutions(uint64_t interfaceId)
-{
     unsigned long retVal;
     unsigned long errorCode;
-
-    unsigned long resList[PDC_MAX_LIST_NUMBER];
-    unsigned long resListSize;
-
-    retVal = PDC_GetResolutionList(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                    IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                    &resListSize,       // Output
-                                    &resList[0],        // Output
-                                    &errorCode);        // Output
-
-    if (retVal == PDC_FAILED)
+    unsigned long deviceStatus;
+    unsigned long i;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (i = 0; i < iterations; i++)
     {
-        throw CamRuntimeError("Failed to retrieve list of valid resolutions!", errorCode);
+        retVal = PDC_GetStatus(IFACE_ID_GET_DEV_NUM(interfaceId),
+                                &deviceStatus,
+                                &errorCode);
+        if (retVal == PDC_FAILED)
+        {
+            throw CamRuntimeError("Error while retrieving device status!", errorCode);
+        }
     }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count() / iterations;
+}
 
-    boost::python::list pyResList;
 
-    unsigned long i;
-    for (i = 0; i < resListSize; i++)
+// Fast call path for the hot entry points. boost::python::def dispatch walks an overload
+// chain and builds converter objects on every call, which costs more than the SDK call
+// itself for getStatus() and friends. These are registered as plain METH_FASTCALL builtins
+// instead: positional arguments only, converted straight to the C++ types.
+#if PY_VERSION_HEX >= 0x03070000
+#define FASTCALL_FLAGS METH_FASTCALL
+#define FASTCALL_PARAMS PyObject * self, PyObject * const * args, Py_ssize_t nargs
+#define FASTCALL_UNPACK_ARGS
+#else
+// No METH_FASTCALL before 3.7, read the arguments straight out of the tuple instead
+#define FASTCALL_FLAGS METH_VARARGS
+#define FASTCALL_PARAMS PyObject * self, PyObject * argTuple
+#define FASTCALL_UNPACK_ARGS \
+    PyObject * const * args = &PyTuple_GET_ITEM(argTuple, 0); \
+    Py_ssize_t nargs = PyTuple_GET_SIZE(argTuple);
+#endif
+
+bool PyHSCam_fastCheckArgs(Py_ssize_t nargs, Py_ssize_t expected)
+{
+    if (nargs != expected)
     {
-        unsigned long width  = (resList[i] & 0xffff0000) >> 16;
-        unsigned long height = (resList[i] & 0x0000ffff);
-        pyResList.append(boost::python::make_tuple(width, height));
+        PyErr_Format(PyExc_TypeError, "expected %d positional argument(s), got %d",
+                        (int)expected, (int)nargs);
+        return false;
     }
-
-    return pyResList;
+    return true;
 }
 
-bool PyHSCam_isDeviceMonochromatic(uint64_t interfaceId)
+bool PyHSCam_fastArg(PyObject * arg, unsigned long long * value)
 {
-    unsigned long retVal;
-    unsigned long errorCode;
-    char colorMode;
-
-    retVal = PDC_GetColorType(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                IFACE_ID_GET_CHILD_NUM(interfaceId),
-                                &colorMode,         // Output
-                                &errorCode);        // Output
-    if (retVal == PDC_FAILED)
+    unsigned long long v = PyLong_AsUnsignedLongLong(arg);
+    if (v == (unsigned long long)-1 && PyErr_Occurred())
     {
-        throw CamRuntimeError("Failed to retrieve device color mode!", errorCode);
+        return false;
     }
+    *value = v;
+    return true;
+}
 
-    if (colorMode == PDC_COLORTYPE_MONO)
+bool PyHSCam_fastArg(PyObject * arg, unsigned long * value)
+{
+    unsigned long v = PyLong_AsUnsignedLong(arg);
+    if (v == (unsigned long)-1 && PyErr_Occurred())
     {
-        return true;
+        return false;
     }
-    return false;
+    *value = v;
+    return true;
 }
 
-unsigned long PyHSCam_getStatus(uint64_t interfaceId)
+PyObject * PyHSCam_fastResult(unsigned long value)
 {
-    unsigned long retVal;
-    unsigned long errorCode;
-    unsigned long deviceStatus;
-    retVal = PDC_GetStatus(IFACE_ID_GET_DEV_NUM(interfaceId),
-                            &deviceStatus,
-                            &errorCode);
-    if (retVal == PDC_FAILED)
-    {
-        throw CamRuntimeError("Error while retrieving device status!", errorCode);
-    }
-    return deviceStatus;
+    return PyLong_FromUnsignedLong(value);
 }
 
+PyObject * PyHSCam_fastResult(long value)
+{
+    return PyLong_FromLong(value);
+}
 
-void PyHSCam_beginRecording(uint64_t interfaceId)
+PyObject * PyHSCam_fastResult(PyObject * value)
 {
-    // Begin recording endlessly (or until we run out of memory).
-    // This function does not handle exiting recording mode or halting recording.
+    // Already a new reference
+    return value;
+}
 
-    unsigned long deviceStatus;
+PyObject * PyHSCam_fastResult(const Resolution & value)
+{
+    return Py_BuildValue("(kk)", value.width, value.height);
+}
 
-    deviceStatus = PyHSCam_getStatus(interfaceId);
-    if (deviceStatus != PDC_STATUS_LIVE)
+void PyHSCam_fastSetError()
+{
+    // Translate the exception currently being handled the same way boost::python would
+    try
     {
-        throw CamRuntimeError("Device attempted to begin recording while not in LIVE mode. "
-                                "This should never happen.");
+        throw;
     }
-
-    unsigned long errorCode;
-    unsigned long retVal;
-
-    retVal = PDC_SetTriggerMode(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                PDC_TRIGGER_END,
-                                0,              // nAFrames: Unused in endless mode
-                                0,              // nRFrames: Unused in endless mode
-                                0,              // nRCount:  Unused in endless mode
-                                &errorCode);    // Output
-    if (retVal == PDC_FAILED)
+    catch (const CamRuntimeError & e)
     {
-        throw CamRuntimeError("Failed to set trigger mode!", errorCode);
+        convertCppExceptionToPy(e);
     }
-
-    retVal = PDC_SetRecReady(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                &errorCode);     // Output
-
-    if (retVal == PDC_FAILED)
+    catch (const boost::python::error_already_set &)
     {
-        throw CamRuntimeError("Failed to set record to ready!", errorCode);
+        // Python error is already set
     }
-
-    clock_t startTime;
-    // Timeout in ms. This check confirms that the camera is operating in record mode
-    // before we begin recording.
-#define STATUS_CHECK_TIMEOUT 1000
-    startTime = clock();
-    bool actionCompleted = false;
-    while ((clock() - startTime) < STATUS_CHECK_TIMEOUT)
+    catch (const std::bad_alloc &)
     {
-        deviceStatus = PyHSCam_getStatus(interfaceId);
-        if ((deviceStatus == PDC_STATUS_RECREADY) ||
-            (deviceStatus == PDC_STATUS_REC))
-        {
-            // The device is ready for recording
-            actionCompleted = true;
-            break;
-        }
+        PyErr_NoMemory();
     }
-    if (!actionCompleted)
+    catch (const std::exception & e)
     {
-        throw CamRuntimeError("Function timed out while waiting for device to enter record-ready state.");
+        PyErr_SetString(PyExc_RuntimeError, e.what());
     }
-
-    // Start the recording
-    retVal = PDC_SetEndless(IFACE_ID_GET_DEV_NUM(interfaceId),
-                                &errorCode);
-    if (retVal == PDC_FAILED)
+    catch (...)
     {
-        throw CamRuntimeError("Device trigger in (begin recording) failed!", errorCode);
+        // Nothing may propagate out of a function called from the interpreter
+        PyErr_SetString(PyExc_RuntimeError, "Unknown C++ exception.");
     }
 }
 
-void PyHSCam_haltRecording(uint64_t interfaceId)
+template <typename Result, Result (*Function)(uint64_t)>
+PyObject * PyHSCam_fastCall(FASTCALL_PARAMS)
 {
-    // Halt recording forcibly by setting the mode to "LIVE"
-    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+    FASTCALL_UNPACK_ARGS
+    uint64_t interfaceId;
+    if (!PyHSCam_fastCheckArgs(nargs, 1) || !PyHSCam_fastArg(args[0], &interfaceId))
+    {
+        return NULL;
+    }
+    try
+    {
+        return PyHSCam_fastResult(Function(interfaceId));
+    }
+    catch (...)
+    {
+        PyHSCam_fastSetError();
+        return NULL;
+    }
+}
 
-    clock_t startTime;
-    unsigned long deviceStatus;
-    startTime = clock();
-    bool actionCompleted = false;
-    while ((clock() - startTime) < STATUS_CHECK_TIMEOUT)
+template <typename Result, typename Arg1, Result (*Function)(uint64_t, Arg1)>
+PyObject * PyHSCam_fastCall(FASTCALL_PARAMS)
+{
+    FASTCALL_UNPACK_ARGS
+    uint64_t interfaceId;
+    Arg1 arg1;
+    if (!PyHSCam_fastCheckArgs(nargs, 2) ||
+        !PyHSCam_fastArg(args[0], &interfaceId) ||
+        !PyHSCam_fastArg(args[1], &arg1))
     {
-        deviceStatus = PyHSCam_getStatus(interfaceId);
-        if (deviceStatus == PDC_STATUS_LIVE)
-        {
-            // The device is ready for recording
-            actionCompleted = true;
-            break;
-        }
+        return NULL;
     }
-    if (!actionCompleted)
+    try
     {
-        throw CamRuntimeError("Function timed out while waiting for device to enter LIVE mode.");
+        return PyHSCam_fastResult(Function(interfaceId, arg1));
+    }
+    catch (...)
+    {
+        PyHSCam_fastSetError();
+        return NULL;
     }
 }
 
+#define FASTCALL_DEF(name, function, doc) \
+    {name, (PyCFunction)(void (*)(void))(function), FASTCALL_FLAGS, doc}
 
-void PyHSCam_recordBlocking(uint64_t interfaceId, uint64_t duration)
+PyMethodDef fastCallMethods[] =
 {
-    unsigned long deviceStatus;
-
-    PyHSCam_assertDeviceStatus(interfaceId, PDC_STATUS_LIVE);
+    FASTCALL_DEF("getStatus",
+                 (PyHSCam_fastCall<unsigned long, PyHSCam_getStatus>),
+                 "getStatus(interfaceId)\n"
+                 "Returns the PDC_STATUS_* value of interfaceId."),
+    FASTCALL_DEF("getCurrentCapRate",
+                 (PyHSCam_fastCall<unsigned long, PyHSCam_getCurrentCapRate>),
+                 "getCurrentCapRate(interfaceId)\n"
+                 "Returns the current capture rate for interfaceId"),
+    FASTCALL_DEF("getCurrentResolution",
+                 (PyHSCam_fastCall<Resolution, PyHSCam_getResolution>),
+                 "getCurrentResolution(interfaceId)\n"
+                 "Returns the current image resolution for interfaceId as a tuple of (width, height)"),
+    FASTCALL_DEF("captureLiveImage",
+                 (PyHSCam_fastCall<PyObject *, PyHSCam_captureLiveImage>),
+                 "captureLiveImage(interfaceId)\n"
+                 "Captures an image and returns the data in a bytes object. "
+                 "By default, color images are in the interleave format (BGRBGR...)"),
+    FASTCALL_DEF("getImageFromMemory",
+                 (PyHSCam_fastCall<PyObject *, unsigned long, PyHSCam_getImageFromMemory>),
+                 "getImageFromMemory(interfaceId, frameN)\n"
+                 "Retrieve frame number 'frameN' taken by interfaceId which was previously "
+                 "saved to device memory. Frames are counted from 0 at the oldest recorded frame "
+                 "in every trigger mode. See also: getMemoryFrameCount(), getTriggerFrame()."),
+    FASTCALL_DEF("getMemoryFrameCount",
+                 (PyHSCam_fastCall<long, PyHSCam_getMemoryFrameCount>),
+                 "getMemoryFrameCount(interfaceId)\n"
+                 "Retrieve the number of frames in memory for the specified interfaceId."),
+    FASTCALL_DEF("publishLiveImage",
+                 (PyHSCam_fastCall<long, PyHSCam_publishLiveImage>),
+                 "publishLiveImage(interfaceId)\n"
+                 "Capture a live image directly into the frame ring. "
+                 "Returns the sequence number of the published frame."),
+    {NULL, NULL, 0, NULL}
+};
 
-    clock_t startTime;
-    startTime = clock();
+void PyHSCam_registerFastCalls()
+{
+    // Add fastCallMethods to the module currently being initialized
+    boost::python::scope module;
+    boost::python::object moduleName = module.attr("__name__");
 
-    // Add 5 ms to account for the time between now and when the recording actually starts.
-    // (Not that precision is too important, but I think it looks nicer if the timer is accurate)
-    // Starting the timer after PyHSCam_beginRecording() is called introduces ~200 ms of extra
-    // uncounted recording time.
-    duration += 5;
-    uint64_t maxTime = PyHSCam_getMaxRecordingTime(interfaceId);
-    duration = (duration < maxTime) ? duration : maxTime;
-    PyHSCam_beginRecording(interfaceId);
-    clock_t curTime;
-    // Wait for recording to finish
-    do
+    PyMethodDef * def;
+    for (def = &fastCallMethods[0]; def->ml_name != NULL; def++)
     {
-        deviceStatus = PyHSCam_getStatus(interfaceId);
-        if ((deviceStatus != PDC_STATUS_ENDLESS) &&
-            (deviceStatus != PDC_STATUS_REC))
+        PyObject * function = PyCFunction_NewEx(def, module.ptr(), moduleName.ptr());
+        if (!function)
         {
-            // Recording has finished.
-            break;
+            boost::python::throw_error_already_set();
         }
-        curTime = clock();
-    } while ((curTime - startTime) < duration);
-    PyHSCam_haltRecording(interfaceId);
-    if ((curTime - startTime) >= maxTime)
-    {
-        throw CamRuntimeError("Recording exceeded available memory!");
+        module.attr(def->ml_name) = boost::python::handle<>(function);
     }
 }
 
@@ -824,6 +4226,13 @@ BOOST_PYTHON_MODULE(PyHSCam)
     pyCamRuntimeError = createExceptionClass("CamRuntimeError");
     boost::python::register_exception_translator<CamRuntimeError>(&convertCppExceptionToPy);
 
+    // getStatus, getCurrentCapRate, getCurrentResolution, captureLiveImage,
+    // getImageFromMemory, getMemoryFrameCount and publishLiveImage
+    PyHSCam_registerFastCalls();
+
+    // Exports the slots handed out by FrameRingReader.getFrame()
+    PyHSCam_registerSlotViewType();
+
     // Create member functions
     boost::python::def("init",
                         PyHSCam_init,
@@ -833,27 +4242,25 @@ BOOST_PYTHON_MODULE(PyHSCam)
                         boost::python::args("targetIp"),
                         "Opens device at the specified ip address. "
                         "Returns interfaceId representing the opened device.");
+    boost::python::def("openDevicesByIp",
+                        PyHSCam_openDevicesByIp,
+                        boost::python::args("targetIps"),
+                        "Opens the devices at each ip address in the list, one after another. "
+                        "Returns a list of interfaceIds in the same order.");
+    boost::python::def("reconnect",
+                        PyHSCam_reconnect,
+                        boost::python::args("interfaceId"),
+                        "Reopens interfaceId from the cached device descriptor and restores its "
+                        "previous resolution and capture rate. Returns the new interfaceId; a frame "
+                        "ring moves with it. Stop any frame server for interfaceId first.");
     boost::python::def("setCapRate",
                         PyHSCam_setCapRate,
                         boost::python::args("interfaceId", "captureRate"),
                         "Attempts to set specified device to a particular capture rate.");
-    boost::python::def("getCurrentCapRate",
-                        PyHSCam_getCurrentCapRate,
-                        boost::python::args("interfaceId"),
-                        "Returns the current capture rate for interfaceId");
     boost::python::def("getValidCapRates",
                         PyHSCam_getValidCapRates,
                         boost::python::args("interfaceId"),
                         "Get a list of all valid capture rates for the specified device.");
-    boost::python::def("captureLiveImage",
-                        PyHSCam_captureLiveImage,
-                        boost::python::args("interfaceId"),
-                        "Captures an image and returns the data in a bytes object. "
-                        "By default, color images are in the interleave format (BGRBGR...)");
-    boost::python::def("getCurrentResolution",
-                        PyHSCam_getCurrentResolution,
-                        boost::python::args("interfaceId"),
-                        "Returns the current image resolution for interfaceId as a tuple of (width, height)");
     boost::python::def("setResolution",
                         PyHSCam_setResolution,
                         boost::python::args("interfaceId", "width", "height"),
@@ -863,19 +4270,171 @@ BOOST_PYTHON_MODULE(PyHSCam)
                         boost::python::args("interfaceId"),
                         "Retrieves a list of valid resolutions for interfaceId. "
                         "Each element is a tuple containing (width, height)");
+    boost::python::def("setTransferBitDepth",
+                        PyHSCam_setTransferBitDepth,
+                        boost::python::args("interfaceId", "bitDepth"),
+                        "Select 8 or 16 bits per sample for all images transferred from interfaceId. "
+                        "16-bit images are returned as little-endian uint16.");
+    boost::python::def("getPixelFormat",
+                        PyHSCam_getPixelFormatName,
+                        boost::python::args("interfaceId"),
+                        "Returns the format of images transferred from interfaceId: "
+                        "'mono8', 'mono16', 'bgr8' or 'bgr16'.");
     boost::python::def("recordBlocking",
                         PyHSCam_recordBlocking,
                         boost::python::args("interfaceId", "duration"),
                         "Capture frames on interfaceId for the specified duration (in ms). "
                         "This function blocks until either recording has completed or the device's "
                         "internal memory fills up.");
-    boost::python::def("getImageFromMemory",
-                        PyHSCam_getImageFromMemory,
-                        boost::python::args("interfaceId", "frameN"),
-                        "Retrieve frame number 'frameN' taken by interfaceId which was previously "
-                        "saved to device memory. See also: getMemoryFrameCount().");
-    boost::python::def("getMemoryFrameCount",
-                        PyHSCam_getMemoryFrameCount,
+    boost::python::def("armTrigger",
+                        PyHSCam_armTrigger,
+                        (boost::python::arg("interfaceId"),
+                            boost::python::arg("mode"),
+                            boost::python::arg("framesBefore") = 0,
+                            boost::python::arg("framesAfter") = 0),
+                        "Arm interfaceId to record around a trigger. mode is 'start' (the trigger starts "
+                        "recording), 'center', 'end' (recording stops at the trigger) or 'manual', which "
+                        "takes exactly one of framesBefore (frames kept before the trigger) or framesAfter "
+                        "(frames recorded after it). Trigger with the external input or triggerIn(), then "
+                        "call waitForTrigger().");
+    boost::python::def("triggerIn",
+                        PyHSCam_triggerIn,
+                        boost::python::args("interfaceId"),
+                        "Send a software trigger to an armed interfaceId.");
+    boost::python::def("waitForTrigger",
+                        PyHSCam_waitForTrigger,
+                        boost::python::args("interfaceId", "timeout"),
+                        "Wait up to timeout ms for an armed interfaceId to be triggered and finish "
+                        "recording. Other python threads keep running meanwhile. Returns False on timeout, "
+                        "leaving the device armed.");
+    boost::python::def("getTriggerWindow",
+                        PyHSCam_getTriggerWindow,
+                        boost::python::args("interfaceId", "framesBefore", "framesAfter"),
+                        "Download only the recorded frames from framesBefore before the trigger frame to "
+                        "framesAfter after it. Returns (firstOffset, frames): a list of bytes objects and "
+                        "the position of the first one relative to the trigger frame.");
+    boost::python::def("getTriggerFrame",
+                        PyHSCam_getTriggerFrame,
+                        boost::python::args("interfaceId"),
+                        "Returns the memory frame number of the trigger frame, for use with "
+                        "getImageFromMemory(), downloadToFile() and the other memory functions.");
+    boost::python::def("captureDarkFrame",
+                        PyHSCam_captureDarkFrame,
+                        boost::python::args("interfaceId", "nFrames"),
+                        "Average nFrames live images (with the lens capped) into the dark reference "
+                        "frame for the current resolution.");
+    boost::python::def("captureFlatFrame",
+                        PyHSCam_captureFlatFrame,
+                        boost::python::args("interfaceId", "nFrames"),
+                        "Average nFrames live images of a uniformly lit target into the flat-field "
+                        "reference frame for the current resolution. Requires a dark frame.");
+    boost::python::def("loadCorrectionFrames",
+                        PyHSCam_loadCorrectionFrames,
+                        boost::python::args("interfaceId", "dark", "flat"),
+                        "Load dark and flat reference frames for the current resolution. Each may be any "
+                        "contiguous buffer (bytes, bytearray, numpy array, ...) in the same layout as "
+                        "captured images. flat may be None for dark subtraction only.");
+    boost::python::def("getCorrectionFrames",
+                        PyHSCam_getCorrectionFrames,
+                        boost::python::args("interfaceId"),
+                        "Returns the (dark, flat) reference frames for the current resolution. "
+                        "flat is None if no flat frame has been set.");
+    boost::python::def("setCorrection",
+                        PyHSCam_setCorrection,
+                        (boost::python::arg("interfaceId"),
+                            boost::python::arg("enabled"),
+                            boost::python::arg("outputBitDepth") = 8),
+                        "Enable or disable dark/flat correction of images returned by captureLiveImage() "
+                        "and getImageFromMemory(). With outputBitDepth=16 images are returned as "
+                        "little-endian uint16 with 8 fractional bits.");
+    boost::python::def("reduceMemory",
+                        PyHSCam_reduceMemory,
+                        boost::python::args("interfaceId", "ops", "startFrame", "frameCount"),
+                        "Stream frameCount frames starting at startFrame from device memory through per-pixel "
+                        "reductions without keeping the frames. ops is a list of 'max', 'mean', 'std' and "
+                        "'argmax'. Returns a dict of op -> bytes: max has the transfer sample type (see "
+                        "getPixelFormat()), mean and std are float32 and argmax is the uint32 frame number of "
+                        "each sample's first maximum.");
+    boost::python::def("downloadToFile",
+                        PyHSCam_downloadToFile,
+                        (boost::python::arg("interfaceId"),
+                            boost::python::arg("path"),
+                            boost::python::arg("startFrame"),
+                            boost::python::arg("frameCount"),
+                            boost::python::arg("overview") = false),
+                        "Download frameCount frames starting at startFrame from device memory into the raw "
+                        "file at path. Progress is checkpointed to path + '.ckpt' and transient read errors "
+                        "are retried, so calling again with the same arguments after a failure, reconnect "
+                        "or restart only fetches the missing frames. Returns the number of frames downloaded. "
+                        "With overview=True, 1/2, 1/4 and 1/8 scale thumbnails are written to path + '.thumb2', "
+                        "'.thumb4' and '.thumb8' and a float32 change score per frame to path + '.scores'.");
+#ifdef PYHSCAM_FAULT_INJECTION
+    boost::python::def("setFaultInjection",
+                        PyHSCam_setFaultInjection,
+                        (boost::python::arg("interval"),
+                            boost::python::arg("errorCode"),
+                            boost::python::arg("failAfter") = 0),
+                        "Testing only: make every interval-th memory read in downloadToFile() fail with "
+                        "errorCode, and with failAfter > 0 every read after the first failAfter as well. "
+                        "Calling it again resets the read count; setFaultInjection(0, 0) disables it.");
+#endif
+    boost::python::def("createFrameRing",
+                        PyHSCam_createFrameRing,
+                        boost::python::args("interfaceId", "name", "slotCount"),
+                        "Create a named shared-memory ring of slotCount frames for interfaceId. "
+                        "Frames published to it can be read by other processes with FrameRingReader.");
+    boost::python::def("destroyFrameRing",
+                        PyHSCam_destroyFrameRing,
+                        boost::python::args("interfaceId"),
+                        "Release the frame ring created for interfaceId.");
+    boost::python::def("publishMemoryImages",
+                        PyHSCam_publishMemoryImages,
+                        boost::python::args("interfaceId", "startFrame", "frameCount"),
+                        "Copy frameCount frames starting at startFrame from device memory into the frame ring. "
+                        "Returns the sequence number of the last published frame.");
+    boost::python::def("startFrameServer",
+                        PyHSCam_startFrameServer,
+                        (boost::python::arg("interfaceId"),
+                            boost::python::arg("port"),
+                            boost::python::arg("bindAddress") = "127.0.0.1"),
+                        "Start a TCP server on port which streams frames from interfaceId to remote "
+                        "clients. Range requests need the device in playback and live subscriptions "
+                        "need it in live; the server never changes the status itself. See "
+                        "frameclient.py for the protocol and a client implementation.");
+    boost::python::def("stopFrameServer",
+                        PyHSCam_stopFrameServer,
                         boost::python::args("interfaceId"),
-                        "Retrieve the number of frames in memory for the specified interfaceId.");
+                        "Stop the frame server for interfaceId and disconnect all clients.");
+    boost::python::def("timeRawGetStatus",
+                        PyHSCam_timeRawGetStatus,
+                        boost::python::args("interfaceId", "iterations"),
+                        "Call the SDK's status query iterations times directly from C++ and return the "
+                        "average seconds per call. Baseline for measuring binding overhead, see benchmark.py.");
+
+    boost::python::class_<FrameRingReader, boost::noncopyable>("FrameRingReader",
+                        "Attaches to a frame ring created by createFrameRing() and returns zero-copy "
+                        "views of the frames in it.",
+                        boost::python::init<std::string>(boost::python::args("name")))
+        .def("latestSequence",
+                        &FrameRingReader::latestSequence,
+                        "Returns the sequence number of the most recently published frame (0 if none).")
+        .def("getFrame",
+                        PyHSCam_getRingFrame,
+                        boost::python::args("self", "seq"),
+                        "Returns a read-only memoryview of frame 'seq', or None if it has been overwritten. "
+                        "The view keeps this reader's mapping open. Call isValid(seq) after using the view "
+                        "to confirm it wasn't overwritten while in use.")
+        .def("isValid",
+                        &FrameRingReader::isValid,
+                        boost::python::args("seq"),
+                        "Returns True if frame 'seq' is still held in the ring.")
+        .def("getFrameNumber",
+                        &FrameRingReader::getFrameNumber,
+                        boost::python::args("seq"),
+                        "Returns the device memory frame number of frame 'seq', or -1 for live images.")
+        .add_property("width", &FrameRingReader::getWidth)
+        .add_property("height", &FrameRingReader::getHeight)
+        .add_property("channels", &FrameRingReader::getChannels)
+        .add_property("bitDepth", &FrameRingReader::getBitDepth)
+        .add_property("slotCount", &FrameRingReader::getSlotCount);
 }
@@ -0,0 +1,39 @@
+"""Per-call overhead of the PyHSCam bindings.
+
+Compares the cost of calling cam.getStatus() from python against calling the SDK's status
+query in a tight C++ loop (cam.timeRawGetStatus). The difference is what the binding layer
+costs per call.
+
+    python benchmark.py 192.168.0.10 [iterations]
+"""
+
+import sys
+import timeit
+
+import PyHSCam as cam
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+    ip = sys.argv[1]
+    iterations = int(sys.argv[2]) if len(sys.argv) > 2 else 100000
+
+    cam.init()
+    iface_id = cam.openDeviceByIp(ip)
+
+    raw = cam.timeRawGetStatus(iface_id, iterations)
+    results = [('raw SDK call', raw)]
+    for name in ('getStatus', 'getCurrentCapRate', 'getCurrentResolution', 'getMemoryFrameCount'):
+        fn = getattr(cam, name)
+        per_call = min(timeit.repeat(lambda: fn(iface_id), number=iterations, repeat=3)) / iterations
+        results.append((name, per_call))
+
+    for name, per_call in results:
+        print('%-22s %8.3f us/call  (%+.3f us over raw)' % (name, per_call * 1e6, (per_call - raw) * 1e6))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -26,12 +26,38 @@ cam.setCapRate(iface_id, cap_rate)
 # Record for 250 ms
 cam.recordBlocking(iface_id, 250)
 
+# Alternatively, record around an event: keep 500 frames before an external trigger
+# and 100 after it, then download only that window
+cam.armTrigger(iface_id, 'manual', framesAfter=100)
+if cam.waitForTrigger(iface_id, 10000):
+    first_offset, window = cam.getTriggerWindow(iface_id, 500, 100)
+
 # Get the number of frames the were recorded
 n_frames = cam.getMemoryFrameCount(iface_id)
 
 # get the last frame - counting starts from 0!
 img_bytes = cam.getImageFromMemory(iface_id, n_frames-1);
 
+# Publish the recording into a shared-memory ring of 64 frames. Other local
+# processes can attach with cam.FrameRingReader('PyHSCam_ring') and read
+# frames without copying them.
+cam.createFrameRing(iface_id, 'PyHSCam_ring', 64)
+reader = cam.FrameRingReader('PyHSCam_ring')
+last_seq = cam.publishMemoryImages(iface_id, 0, min(n_frames, 64))
+frame_view = reader.getFrame(last_seq)
+del frame_view
+del reader
+cam.destroyFrameRing(iface_id)
+
+# Save the recording to disk along with 1/2, 1/4 and 1/8 scale thumbnails and a
+# per-frame change score, then find the frame that differs most from the one before it
+cam.downloadToFile(iface_id, 'recording.raw', 0, n_frames, overview=True)
+import array
+scores = array.array('f')
+with open('recording.raw.scores', 'rb') as f:
+    scores.frombytes(f.read())
+busiest_frame = max(range(len(scores)), key=scores.__getitem__)
+
 # Capture a live image
 img_bytes = cam.captureLiveImage(iface_id)
 
@@ -0,0 +1,136 @@
+"""Client for the PyHSCam frame server (see PyHSCam.startFrameServer).
+
+Example, on the acquisition machine:
+
+    import PyHSCam as cam
+    cam.init()
+    iface_id = cam.openDeviceByIp('192.168.0.10')
+    cam.startFrameServer(iface_id, 5555, '0.0.0.0')
+
+and on the analysis machine (or the same machine over loopback):
+
+    from frameclient import FrameClient
+    client = FrameClient('127.0.0.1', 5555)
+    n_frames, width, height, channels, bit_depth = client.info()
+    client.setRoi(0, 0, width // 2, height // 2, decimation=2)
+    for frame_n, width, height, channels, bit_depth, data in client.getRange(0, n_frames):
+        ...
+"""
+
+import socket
+import struct
+
+REQUEST_MAGIC = 0x51525348  # "HSRQ"
+FRAME_MAGIC = 0x52465348    # "HSFR"
+
+CMD_INFO = 0
+CMD_GET_RANGE = 1
+CMD_SUBSCRIBE_LIVE = 2
+CMD_SET_ROI = 3
+
+_REQUEST = struct.Struct('<7I')
+_FRAME_HEADER = struct.Struct('<IiIIIIII')
+
+
+class FrameServerError(Exception):
+    def __init__(self, status):
+        Exception.__init__(self, 'Frame server returned error status %d' % status)
+        self.errorCode = status
+
+
+class FrameClient(object):
+    def __init__(self, host, port):
+        self.sock = socket.create_connection((host, port))
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def close(self):
+        self.sock.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def _send(self, command, *args):
+        args = list(args) + [0] * (5 - len(args))
+        self.sock.sendall(_REQUEST.pack(REQUEST_MAGIC, command, *args))
+
+    def _recvExact(self, size):
+        buf = bytearray(size)
+        view = memoryview(buf)
+        received = 0
+        while received < size:
+            n = self.sock.recv_into(view[received:], size - received)
+            if n == 0:
+                raise ConnectionError('Frame server closed the connection')
+            received += n
+        return buf
+
+    def _recvFrame(self):
+        # Returns (frameNumber, width, height, channels, bitDepth, data)
+        magic, frame_n, width, height, channels, bit_depth, size, status = \
+            _FRAME_HEADER.unpack(self._recvExact(_FRAME_HEADER.size))
+        if magic != FRAME_MAGIC:
+            raise ConnectionError('Bad frame header from frame server')
+        if status != 0:
+            raise FrameServerError(status)
+        data = self._recvExact(size) if size else bytearray()
+        return frame_n, width, height, channels, bit_depth, data
+
+    def info(self):
+        """Returns (recordedFrames, width, height, channels, bitDepth)."""
+        self._send(CMD_INFO)
+        n_frames, width, height, channels, bit_depth, _ = self._recvFrame()
+        return n_frames, width, height, channels, bit_depth
+
+    def setRoi(self, x, y, width, height, decimation=1):
+        """Crop (and optionally decimate) all following frames. width=0 selects the full frame.
+        Returns the (width, height) of frames that will be sent."""
+        self._send(CMD_SET_ROI, x, y, width, height, decimation)
+        _, out_width, out_height, _, _, _ = self._recvFrame()
+        return out_width, out_height
+
+    def getRange(self, start, count):
+        """Yields (frameNumber, width, height, channels, bitDepth, data) for frames in device memory."""
+        self._send(CMD_GET_RANGE, start, count)
+        for _ in range(count):
+            yield self._recvFrame()
+
+    def subscribeLive(self, count=0):
+        """Yields count live frames as (frameNumber, width, height, channels, bitDepth, data).
+        With count=0 frames are streamed until the generator is closed (e.g. by breaking out
+        of the loop), which ends the subscription on the server."""
+        self._send(CMD_SUBSCRIBE_LIVE, count)
+        if count:
+            for _ in range(count):
+                yield self._recvFrame()
+            return
+
+        streaming = True
+        try:
+            while True:
+                try:
+                    frame = self._recvFrame()
+                except Exception:
+                    # The server ended the subscription itself, or the connection is gone
+                    streaming = False
+                    raise
+                yield frame
+        finally:
+            if streaming:
+                self._endSubscription()
+
+    def _endSubscription(self):
+        # Any request ends an open-ended subscription. Send an info request and discard
+        # live frames already in flight up to its reply, the first header without a payload.
+        self._send(CMD_INFO)
+        while True:
+            header = _FRAME_HEADER.unpack(self._recvExact(_FRAME_HEADER.size))
+            if header[0] != FRAME_MAGIC:
+                raise ConnectionError('Bad frame header from frame server')
+            size, status = header[6], header[7]
+            if size:
+                self._recvExact(size)
+            elif status == 0:
+                return
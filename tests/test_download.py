@@ -0,0 +1,108 @@
+"""Resumable download tests. These need a camera and a module built with
+define=PYHSCAM_FAULT_INJECTION:
+
+    set PYHSCAM_TEST_IP=192.168.0.10
+    python -m unittest discover tests
+"""
+
+import os
+import shutil
+import tempfile
+import unittest
+
+TEST_IP = os.environ.get('PYHSCAM_TEST_IP')
+INJECTED_ERROR = 7
+
+
+@unittest.skipUnless(TEST_IP, 'PYHSCAM_TEST_IP is not set')
+class DownloadResumeTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        import PyHSCam as cam
+        if not hasattr(cam, 'setFaultInjection'):
+            raise unittest.SkipTest('module built without PYHSCAM_FAULT_INJECTION')
+        cls.cam = cam
+        cam.init()
+        cls.iface_id = cam.openDeviceByIp(TEST_IP)
+        cam.setCorrection(cls.iface_id, False, 8)
+        cam.recordBlocking(cls.iface_id, 100)
+        cls.frame_count = min(cam.getMemoryFrameCount(cls.iface_id), 40)
+
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.dir, 'download.raw')
+
+    def tearDown(self):
+        self.cam.setFaultInjection(0, 0)
+        shutil.rmtree(self.dir)
+
+    def assertMatchesMemory(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        frame_size = len(data) // self.frame_count
+        for frame_n in range(self.frame_count):
+            self.assertEqual(data[frame_n * frame_size:(frame_n + 1) * frame_size],
+                             self.cam.getImageFromMemory(self.iface_id, frame_n),
+                             'frame %d differs' % frame_n)
+
+    def test_resume_after_retries_exhausted(self):
+        # The link "drops" after 10 reads: every retry of the 11th frame fails
+        good_reads = 10
+        self.cam.setFaultInjection(0, INJECTED_ERROR, good_reads)
+        with self.assertRaises(self.cam.CamRuntimeError) as ctx:
+            self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count)
+        self.assertEqual(ctx.exception.errorCode, INJECTED_ERROR)
+        self.assertTrue(os.path.exists(self.path + '.ckpt'))
+
+        # Only the missing frames are fetched on the second call
+        self.cam.setFaultInjection(0, 0)
+        downloaded = self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count)
+        self.assertEqual(downloaded, self.frame_count - good_reads)
+        self.assertMatchesMemory(self.path)
+
+        # A completed download has nothing left to fetch
+        self.assertEqual(self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count), 0)
+
+    def test_rejects_checkpoint_of_other_recording(self):
+        self.cam.setFaultInjection(0, INJECTED_ERROR, 10)
+        with self.assertRaises(self.cam.CamRuntimeError):
+            self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count)
+        self.cam.setFaultInjection(0, 0)
+
+        # Make the checkpoint claim a recording that started one frame later
+        with open(self.path + '.ckpt') as f:
+            lines = f.readlines()
+        fields = lines[0].split()
+        fields[8] = str(int(fields[8]) + 1)
+        lines[0] = ' '.join(fields) + '\n'
+        with open(self.path + '.ckpt', 'w') as f:
+            f.writelines(lines)
+
+        with self.assertRaises(self.cam.CamRuntimeError):
+            self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count)
+
+    def test_transient_failures_are_retried(self):
+        # Every third read fails once; the retry after it succeeds
+        self.cam.setFaultInjection(3, INJECTED_ERROR)
+        downloaded = self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count)
+        self.assertEqual(downloaded, self.frame_count)
+        self.cam.setFaultInjection(0, 0)
+        self.assertMatchesMemory(self.path)
+
+    def test_resume_with_overview(self):
+        self.cam.setFaultInjection(0, INJECTED_ERROR, 10)
+        with self.assertRaises(self.cam.CamRuntimeError):
+            self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count, overview=True)
+        self.cam.setFaultInjection(0, 0)
+        self.cam.downloadToFile(self.iface_id, self.path, 0, self.frame_count, overview=True)
+
+        # Scores computed across the resume point must match a download done in one go
+        reference = os.path.join(self.dir, 'reference.raw')
+        self.cam.downloadToFile(self.iface_id, reference, 0, self.frame_count, overview=True)
+        for suffix in ('', '.thumb2', '.thumb4', '.thumb8', '.scores'):
+            with open(self.path + suffix, 'rb') as a, open(reference + suffix, 'rb') as b:
+                self.assertEqual(a.read(), b.read(), suffix or 'data')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,215 @@
+"""Frame server tests using the bundled client (frameclient.py).
+
+FrameClientProtocolTest runs anywhere against a small in-process server that follows the
+protocol described in PyHSCam.cpp. FrameServerLoopbackTest runs the real server over
+loopback and needs a camera:
+
+    set PYHSCAM_TEST_IP=192.168.0.10
+    python -m unittest discover tests
+"""
+
+import os
+import select
+import socket
+import struct
+import sys
+import threading
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+import frameclient
+from frameclient import FrameClient, FrameServerError
+
+TEST_IP = os.environ.get('PYHSCAM_TEST_IP')
+
+_REQUEST = struct.Struct('<7I')
+_FRAME_HEADER = struct.Struct('<IiIIIIII')
+
+
+class FakeFrameServer(object):
+    """Serves a fixed 8-bit mono recording; live frames count up from 0."""
+
+    def __init__(self, width=8, height=4, frame_count=5):
+        self.width = width
+        self.height = height
+        self.frames = [bytes([n] * width * height) for n in range(frame_count)]
+        self.listener = socket.socket()
+        self.listener.bind(('127.0.0.1', 0))
+        self.listener.listen(1)
+        self.port = self.listener.getsockname()[1]
+        self.thread = threading.Thread(target=self._serve)
+        self.thread.daemon = True
+        self.thread.start()
+
+    def close(self):
+        self.listener.close()
+
+    def _recvRequest(self, sock):
+        data = b''
+        while len(data) < _REQUEST.size:
+            chunk = sock.recv(_REQUEST.size - len(data))
+            if not chunk:
+                return None
+            data += chunk
+        return _REQUEST.unpack(data)
+
+    def _send(self, sock, frame_n, payload=b'', status=0, width=None, height=None):
+        sock.sendall(_FRAME_HEADER.pack(frameclient.FRAME_MAGIC, frame_n,
+                                        self.width if width is None else width,
+                                        self.height if height is None else height,
+                                        1, 8, len(payload), status) + payload)
+
+    def _serve(self):
+        try:
+            sock, _ = self.listener.accept()
+            with sock:
+                self._serveConnection(sock)
+        except OSError:
+            # The client disconnected or the test closed the listener
+            pass
+
+    def _serveConnection(self, sock):
+        request = self._recvRequest(sock)
+        while request is not None:
+            _, command, a0, a1, _, _, _ = request
+            request = None
+            if command == frameclient.CMD_INFO:
+                self._send(sock, len(self.frames))
+            elif command == frameclient.CMD_GET_RANGE:
+                if a0 + a1 > len(self.frames):
+                    self._send(sock, -1, status=0xFFFFFFFF)
+                else:
+                    for frame_n in range(a0, a0 + a1):
+                        self._send(sock, frame_n, self.frames[frame_n])
+            elif command == frameclient.CMD_SUBSCRIBE_LIVE:
+                sent = 0
+                while a0 == 0 or sent < a0:
+                    # Like the real server, any new request ends the subscription
+                    if select.select([sock], [], [], 0)[0]:
+                        request = self._recvRequest(sock)
+                        break
+                    self._send(sock, -1, bytes([sent % 256]) * (self.width * self.height))
+                    sent += 1
+            if request is None:
+                request = self._recvRequest(sock)
+
+
+class FrameClientProtocolTest(unittest.TestCase):
+    def setUp(self):
+        self.server = FakeFrameServer()
+        self.client = FrameClient('127.0.0.1', self.server.port)
+
+    def tearDown(self):
+        self.client.close()
+        self.server.close()
+
+    def test_info(self):
+        self.assertEqual(self.client.info(), (5, 8, 4, 1, 8))
+
+    def test_get_range(self):
+        frames = list(self.client.getRange(1, 3))
+        self.assertEqual([f[0] for f in frames], [1, 2, 3])
+        self.assertEqual(frames[2][5], self.server.frames[3])
+
+    def test_get_range_error(self):
+        with self.assertRaises(FrameServerError):
+            list(self.client.getRange(4, 3))
+
+    def test_counted_subscription(self):
+        frames = list(self.client.subscribeLive(3))
+        self.assertEqual(len(frames), 3)
+        self.assertEqual(self.client.info()[0], 5)
+
+    def test_open_ended_subscription(self):
+        received = 0
+        for frame in self.client.subscribeLive():
+            self.assertEqual(frame[0], -1)
+            received += 1
+            if received == 20:
+                break
+        # Frames still in flight must not be mistaken for later replies
+        self.assertEqual(self.client.info(), (5, 8, 4, 1, 8))
+        self.assertEqual([f[0] for f in self.client.getRange(0, 2)], [0, 1])
+
+
+@unittest.skipUnless(TEST_IP, 'PYHSCAM_TEST_IP is not set')
+class FrameServerLoopbackTest(unittest.TestCase):
+    PORT = 5555
+
+    @classmethod
+    def setUpClass(cls):
+        import PyHSCam as cam
+        cls.cam = cam
+        cam.init()
+        cls.iface_id = cam.openDeviceByIp(TEST_IP)
+        cam.setCorrection(cls.iface_id, False)
+        cam.recordBlocking(cls.iface_id, 100)
+        cls.frame_count = cam.getMemoryFrameCount(cls.iface_id)
+        cls.width, cls.height = cam.getCurrentResolution(cls.iface_id)
+        cam.startFrameServer(cls.iface_id, cls.PORT)
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.cam.stopFrameServer(cls.iface_id)
+
+    def setUp(self):
+        self.client = FrameClient('127.0.0.1', self.PORT)
+
+    def tearDown(self):
+        self.client.close()
+
+    def test_info(self):
+        self.cam.getMemoryFrameCount(self.iface_id)
+        n_frames, width, height, _, _ = self.client.info()
+        self.assertEqual((n_frames, width, height), (self.frame_count, self.width, self.height))
+
+    def test_get_range_matches_memory(self):
+        count = min(self.frame_count, 4)
+        for frame_n, _, _, _, _, data in self.client.getRange(0, count):
+            self.assertEqual(bytes(data), self.cam.getImageFromMemory(self.iface_id, frame_n))
+
+    def test_roi(self):
+        full = list(self.client.getRange(0, 1))[0]
+        bytes_per_pixel = len(full[5]) // (self.width * self.height)
+        self.assertEqual(self.client.setRoi(2, 1, 4, 3), (4, 3))
+        frame = list(self.client.getRange(0, 1))[0]
+        row = self.width * bytes_per_pixel
+        expected = b''.join(bytes(full[5][(1 + y) * row + 2 * bytes_per_pixel:
+                                          (1 + y) * row + 6 * bytes_per_pixel]) for y in range(3))
+        self.assertEqual(bytes(frame[5]), expected)
+
+    def test_rejects_roi_outside_frame(self):
+        for roi in ((0xFFFFFFFF, 0, 1, 1), (0, 0xFFFFFFFF, 1, 1), (self.width, 0, 1, 1)):
+            with self.assertRaises(FrameServerError):
+                self.client.setRoi(*roi)
+        with self.assertRaises(FrameServerError):
+            self.client.setRoi(0, 0, 2, 2, decimation=3)
+
+    def test_requests_leave_status_alone(self):
+        # Remote requests fail rather than switch the device out of its current mode
+        self.cam.captureLiveImage(self.iface_id)
+        self.addCleanup(self.cam.getMemoryFrameCount, self.iface_id)
+        status = self.cam.getStatus(self.iface_id)
+        with self.assertRaises(FrameServerError):
+            list(self.client.getRange(0, 1))
+        self.assertEqual(self.cam.getStatus(self.iface_id), status)
+
+        self.cam.getMemoryFrameCount(self.iface_id)
+        status = self.cam.getStatus(self.iface_id)
+        with self.assertRaises(FrameServerError):
+            list(self.client.subscribeLive(1))
+        self.assertEqual(self.cam.getStatus(self.iface_id), status)
+
+    def test_open_ended_subscription(self):
+        self.cam.captureLiveImage(self.iface_id)
+        self.addCleanup(self.cam.getMemoryFrameCount, self.iface_id)
+        for received, frame in enumerate(self.client.subscribeLive(), 1):
+            self.assertEqual(frame[0], -1)
+            if received == 5:
+                break
+        self.assertEqual(self.client.info()[1:3], (self.width, self.height))
+
+
+if __name__ == '__main__':
+    unittest.main()